@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/fft.hpp>
+
+/**
+ * Chebyshev proxies of smooth functions.
+ *
+ * chebyshev(f, x, a, b, tolerance, coeffs...) replaces f, as a function
+ * of the variable x on [a, b], by a Chebyshev series
+ *   p(x) = sum over k of c_k T_k(t),  t = (2x - a - b) / (b - a)
+ * The other variables of f are set to the coefficients. f is sampled at
+ * 17, 33, 65, ... Chebyshev points, the series computed by a fast cosine
+ * transform, until the coefficients decay below the tolerance: the
+ * series is then truncated where the sum of the dropped |c_k|, a bound
+ * of the truncation error, stays below half the tolerance.
+ * chebyshev(f, x, y, {ax, bx}, {ay, by}, tolerance, coeffs...) does the
+ * same with a tensor product series in two variables.
+ *
+ * The proxy is a node evaluated by the Clenshaw recurrence, a multiply
+ * and an add per term (fused where the target has FMA), from a table
+ * of coefficients shared between copies of the node: a few hundred
+ * bytes that stay in cache. Its derivatives are proxies too, with
+ * coefficients from the derivative recurrence.
+ * error is the estimated bound of |f - p| on the domain. When f is not
+ * resolved by the maximum degree (a kink or a singularity) it is a rough
+ * estimate from the last coefficients, above the tolerance; NaN for
+ * derivatives.
+ */
+namespace veritacpp::dsl::math {
+
+// highest degree tried per variable
+inline constexpr size_t kChebyshevMaxDegree = 4096;
+inline constexpr size_t kChebyshevMaxDegree2d = 256;
+
+namespace detail {
+
+/**
+ * Chebyshev coefficients of the values at the n + 1 points cos(pi j / n),
+ * by a real transform of the even extension of length 2n
+ */
+inline std::vector<double> chebyshev_coefficients(std::span<const double> values) {
+    const size_t n = values.size() - 1;
+    if (n == 0) {
+        return { values[0] };
+    }
+    std::vector<std::complex<double>> extended(2 * n);
+    for (size_t j = 0; j <= n; ++j) {
+        extended[j] = values[j];
+    }
+    for (size_t j = 1; j < n; ++j) {
+        extended[2 * n - j] = values[j];
+    }
+    const auto transformed = fft(extended);
+    std::vector<double> c(n + 1);
+    for (size_t k = 0; k <= n; ++k) {
+        c[k] = transformed[k].real() / double(n);
+    }
+    c[0] /= 2;
+    c[n] /= 2;
+    return c;
+}
+
+// Chebyshev points of [-1, 1], from 1 down to -1
+inline std::vector<double> chebyshev_points(size_t n) {
+    std::vector<double> t(n + 1);
+    for (size_t j = 0; j <= n; ++j) {
+        // sin of the complement keeps the points symmetric in rounding
+        t[j] = std::sin(std::numbers::pi * (double(n) - 2 * double(j)) / (2 * double(n)));
+    }
+    return t;
+}
+
+/**
+ * Smallest degree m whose dropped tail, the sum of tail[k] for k > m,
+ * is at most budget, and that tail
+ */
+inline std::pair<size_t, double> truncation(std::span<const double> tail, double budget) {
+    double dropped = 0;
+    size_t m = tail.size();
+    while (m > 1 && dropped + tail[m - 1] <= budget) {
+        dropped += tail[--m];
+    }
+    return { m - 1, dropped };
+}
+
+// resolved: the last quarter of the sampled coefficients was dropped
+inline bool resolved(size_t degree, size_t n) {
+    return degree <= n - n / 4;
+}
+
+// rough error of an unresolved series: twice its last quarter
+inline double unresolved_error(std::span<const double> tail) {
+    const size_t n = tail.size() - 1;
+    double sum = 0;
+    for (size_t k = n - n / 4 + 1; k <= n; ++k) {
+        sum += tail[k];
+    }
+    return 2 * sum;
+}
+
+// sum of c_k T_k(t)
+inline double clenshaw(const double* c, size_t terms, double t) {
+    double b1 = 0;
+    double b2 = 0;
+    const double two_t = 2 * t;
+    for (size_t k = terms; k-- > 1;) {
+        const double b = two_t * b1 + (c[k] - b2);
+        b2 = b1;
+        b1 = b;
+    }
+    return t * b1 + (c[0] - b2);
+}
+
+// coefficients of the derivative with respect to t, of degree one less
+inline std::vector<double> chebyshev_derivative(const double* c, size_t terms, double scale) {
+    if (terms <= 1) {
+        return { 0.0 };
+    }
+    std::vector<double> d(terms - 1, 0.0);
+    double next = 0;    // d_{k+1}
+    double current = 0; // d_k
+    for (size_t k = terms - 1; k >= 1; --k) {
+        const double previous = next + 2 * double(k) * c[k];
+        d[k - 1] = previous;
+        next = current;
+        current = previous;
+    }
+    d[0] /= 2;
+    for (auto& v : d) {
+        v *= scale;
+    }
+    return d;
+}
+
+// argument idx of f: one of the proxy variables or a coefficient
+template <uint64_t idx, uint64_t I, uint64_t J, class Coefficients>
+constexpr auto grid_argument(double x, double y, const Coefficients& c) {
+    if constexpr (idx == I) {
+        return x;
+    } else if constexpr (idx == J) {
+        return y;
+    } else {
+        return std::get<idx - (idx > I) - (idx > J)>(c);
+    }
+}
+
+// value of argument I of a call
+template <uint64_t I, class... X>
+constexpr double argument(X... x) {
+    return static_cast<double>(std::get<I>(std::make_tuple(x...)));
+}
+
+} // namespace detail
+
+
+/**
+ * Chebyshev series in the variable I on [a, b]
+ */
+template <uint64_t I>
+struct Chebyshev : FunctionNode<Chebyshev<I>> {
+    static constexpr uint64_t arity = I + 1;
+
+    std::shared_ptr<const std::vector<double>> coefficients;
+    double a = -1;
+    double b = 1;
+    double error = 0;
+
+    size_t degree() const {
+        return coefficients->size() - 1;
+    }
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    Arithmetic auto operator()(X... x) const {
+        const double t = (2 * detail::argument<I>(x...) - a - b) / (b - a);
+        return detail::clenshaw(coefficients->data(), coefficients->size(), t);
+    }
+};
+
+/**
+ * Tensor product series in the variables I and J on [ax, bx] x [ay, by]:
+ * coefficient (i, j), of T_i(tx) T_j(ty), at i * columns + j
+ */
+template <uint64_t I, uint64_t J>
+struct Chebyshev2 : FunctionNode<Chebyshev2<I, J>> {
+    static constexpr uint64_t arity = std::max(I, J) + 1;
+
+    std::shared_ptr<const std::vector<double>> coefficients;
+    size_t rows = 1;
+    size_t columns = 1;
+    std::pair<double, double> xs{ -1, 1 };
+    std::pair<double, double> ys{ -1, 1 };
+    double error = 0;
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    Arithmetic auto operator()(X... x) const {
+        const double tx = (2 * detail::argument<I>(x...) - xs.first - xs.second) / (xs.second - xs.first);
+        const double ty = (2 * detail::argument<J>(x...) - ys.first - ys.second) / (ys.second - ys.first);
+        // Clenshaw over the rows, each row a series in ty
+        const auto* c = coefficients->data();
+        double b1 = 0;
+        double b2 = 0;
+        for (size_t i = rows; i-- > 1;) {
+            const double row = detail::clenshaw(c + i * columns, columns, ty);
+            const double b = 2 * tx * b1 + (row - b2);
+            b2 = b1;
+            b1 = b;
+        }
+        return tx * b1 + (detail::clenshaw(c, columns, ty) - b2);
+    }
+};
+
+/**
+ * Proxy of f in x on [a, b], see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Chebyshev<I> chebyshev(const F& f, Variable<I>, double a, double b, double tolerance,
+                       C... coefficients) {
+    assert(a < b && tolerance > 0);
+    const auto c = std::make_tuple(coefficients...);
+    const auto sample = [&](double x) {
+        return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return static_cast<double>(
+                evaluate<Policy>(f, detail::grid_argument<idx, I, uint64_t(-1)>(x, 0, c)...));
+        }(std::make_index_sequence<sizeof...(C) + 1>{});
+    };
+
+    Chebyshev<I> proxy;
+    proxy.a = a;
+    proxy.b = b;
+    for (size_t n = 16;; n *= 2) {
+        const auto t = detail::chebyshev_points(n);
+        std::vector<double> values(n + 1);
+        for (size_t j = 0; j <= n; ++j) {
+            values[j] = sample(0.5 * (a + b) + 0.5 * (b - a) * t[j]);
+        }
+        auto series = detail::chebyshev_coefficients(values);
+        std::vector<double> tail(series.size());
+        std::transform(series.begin(), series.end(), tail.begin(),
+                       [](double v) { return std::abs(v); });
+        const auto [degree, dropped] = detail::truncation(tail, tolerance / 2);
+        if (detail::resolved(degree, n) || 2 * n > kChebyshevMaxDegree) {
+            series.resize(degree + 1);
+            proxy.error = detail::resolved(degree, n) ? dropped : detail::unresolved_error(tail);
+            proxy.coefficients = std::make_shared<const std::vector<double>>(std::move(series));
+            return proxy;
+        }
+    }
+}
+
+/**
+ * Proxy of f in x and y on [xs.first, xs.second] x [ys.first, ys.second],
+ * see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, uint64_t J, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 2, F> && (I != J) &&
+         (I <= sizeof...(C) + 1) && (J <= sizeof...(C) + 1)
+Chebyshev2<I, J> chebyshev(const F& f, Variable<I>, Variable<J>, std::pair<double, double> xs,
+                           std::pair<double, double> ys, double tolerance, C... coefficients) {
+    assert(xs.first < xs.second && ys.first < ys.second && tolerance > 0);
+    const auto c = std::make_tuple(coefficients...);
+    const auto sample = [&](double x, double y) {
+        return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return static_cast<double>(
+                evaluate<Policy>(f, detail::grid_argument<idx, I, J>(x, y, c)...));
+        }(std::make_index_sequence<sizeof...(C) + 2>{});
+    };
+
+    Chebyshev2<I, J> proxy;
+    proxy.xs = xs;
+    proxy.ys = ys;
+    for (size_t n = 16;; n *= 2) {
+        const auto t = detail::chebyshev_points(n);
+        const size_t m = n + 1;
+        // values on the grid, then transforms of the rows and of the columns
+        std::vector<double> grid(m * m), line(m);
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                line[j] = sample(0.5 * (xs.first + xs.second) + 0.5 * (xs.second - xs.first) * t[i],
+                                 0.5 * (ys.first + ys.second) + 0.5 * (ys.second - ys.first) * t[j]);
+            }
+            const auto row = detail::chebyshev_coefficients(line);
+            std::copy(row.begin(), row.end(), grid.begin() + i * m);
+        }
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t i = 0; i < m; ++i) {
+                line[i] = grid[i * m + j];
+            }
+            const auto column = detail::chebyshev_coefficients(line);
+            for (size_t i = 0; i < m; ++i) {
+                grid[i * m + j] = column[i];
+            }
+        }
+
+        // the error budget is shared by the two directions
+        std::vector<double> tail_x(m, 0.0), tail_y(m, 0.0);
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                tail_x[i] += std::abs(grid[i * m + j]);
+                tail_y[j] += std::abs(grid[i * m + j]);
+            }
+        }
+        const auto [rows, dropped_x] = detail::truncation(tail_x, tolerance / 4);
+        const auto [columns, dropped_y] = detail::truncation(tail_y, tolerance / 4);
+        const bool resolved = detail::resolved(rows, n) && detail::resolved(columns, n);
+        if (resolved || 2 * n > kChebyshevMaxDegree2d) {
+            std::vector<double> series((rows + 1) * (columns + 1));
+            for (size_t i = 0; i <= rows; ++i) {
+                std::copy_n(grid.begin() + i * m, columns + 1, series.begin() + i * (columns + 1));
+            }
+            proxy.rows = rows + 1;
+            proxy.columns = columns + 1;
+            proxy.error = resolved ? dropped_x + dropped_y
+                                   : detail::unresolved_error(tail_x) + detail::unresolved_error(tail_y);
+            proxy.coefficients = std::make_shared<const std::vector<double>>(std::move(series));
+            return proxy;
+        }
+    }
+}
+
+
+template <uint64_t I, uint64_t xid>
+Functional auto diff(const Chebyshev<I>& p, Variable<xid>) {
+    if constexpr (xid != I) {
+        return kZero;
+    } else {
+        Chebyshev<I> d = p;
+        d.coefficients = std::make_shared<const std::vector<double>>(detail::chebyshev_derivative(
+            p.coefficients->data(), p.coefficients->size(), 2 / (p.b - p.a)));
+        d.error = std::numeric_limits<double>::quiet_NaN();
+        return d;
+    }
+}
+
+// the derivative recurrence along the rows or along the columns
+template <uint64_t I, uint64_t J, uint64_t xid>
+Functional auto diff(const Chebyshev2<I, J>& p, Variable<xid>) {
+    if constexpr (xid != I && xid != J) {
+        return kZero;
+    } else {
+        constexpr bool along_x = xid == I;
+        const auto& c = *p.coefficients;
+        const size_t count = along_x ? p.columns : p.rows;
+        const size_t length = along_x ? p.rows : p.columns;
+        const double scale = along_x ? 2 / (p.xs.second - p.xs.first) : 2 / (p.ys.second - p.ys.first);
+        const size_t rows = along_x ? std::max<size_t>(1, p.rows - 1) : p.rows;
+        const size_t columns = along_x ? p.columns : std::max<size_t>(1, p.columns - 1);
+
+        std::vector<double> series(rows * columns), line(length);
+        for (size_t s = 0; s < count; ++s) {
+            for (size_t k = 0; k < length; ++k) {
+                line[k] = along_x ? c[k * p.columns + s] : c[s * p.columns + k];
+            }
+            const auto d = detail::chebyshev_derivative(line.data(), length, scale);
+            for (size_t k = 0; k < d.size(); ++k) {
+                (along_x ? series[k * columns + s] : series[s * columns + k]) = d[k];
+            }
+        }
+        Chebyshev2<I, J> d = p;
+        d.rows = rows;
+        d.columns = columns;
+        d.coefficients = std::make_shared<const std::vector<double>>(std::move(series));
+        d.error = std::numeric_limits<double>::quiet_NaN();
+        return d;
+    }
+}
+
+} // veritacpp::dsl::math
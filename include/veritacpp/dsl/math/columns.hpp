@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/serialize.hpp>
+
+#include <veritacpp/utils/mapped_file.hpp>
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Evaluation over column files.
+ *
+ * evaluate_columns(f, {"x0.bin", "x1.bin"}, "out.bin") writes
+ * f(x0[i], x1[i]) for every row i. Columns are raw native doubles, one
+ * file per variable, all of the same length. Inputs are mapped
+ * read-only and the output file is created and mapped writable, so
+ * rows go from the page cache to evaluate_batch and back without
+ * staging copies.
+ *
+ * Rows are processed in windows of chunks: the chunks of a window are
+ * evaluated on the thread pool while the kernel reads the next window
+ * ahead, and pages of finished windows are written back and released.
+ * Memory held by the process stays at about two windows, whatever the
+ * size of the files.
+ *
+ * f is a Functional, evaluated with the given Policy, or an
+ * ExpressionImage.
+ */
+namespace veritacpp::dsl::math {
+
+enum class ColumnStatus : uint8_t {
+    Ok,
+    IoError,
+    SizeMismatch,   // a column is not whole doubles, or columns differ in length
+    OutputIsInput,  // the output names an input file: creating it would truncate the input
+    InvalidImage    // the image did not open, or needs more arguments than there are columns
+};
+
+struct ColumnOptions {
+    size_t chunk_rows = 1 << 15;      // rows per task: 256 KiB of every column
+    size_t window_chunks = 0;         // chunks per window, 0: four per thread
+};
+
+struct ColumnResult {
+    size_t rows = 0;
+    ColumnStatus status = ColumnStatus::Ok;
+};
+
+namespace detail {
+
+template <class Policy, class F, size_t... Is>
+void evaluate_rows(const F& f, std::span<double> out,
+                   const std::array<const double*, sizeof...(Is)>& in,
+                   std::index_sequence<Is...>) {
+    if constexpr (std::same_as<F, ExpressionImage>) {
+        f.evaluate_batch(out, in);
+    } else {
+        evaluate_batch<Policy>(f, out, std::span<const double>(in[Is], out.size())...);
+    }
+}
+
+} // namespace detail
+
+template <class Policy = Precise, class F, size_t N>
+requires Functional<F> || std::same_as<F, ExpressionImage>
+ColumnResult evaluate_columns(const F& f, const std::string (&inputs)[N],
+                              const std::string& output, const ColumnOptions& options = {}) {
+    ColumnResult result;
+    if constexpr (std::same_as<F, ExpressionImage>) {
+        // the interpreter trusts both, also without assertions
+        if (!f.valid() || f.variables() > N) {
+            result.status = ColumnStatus::InvalidImage;
+            return result;
+        }
+    }
+    std::array<uint64_t, N> sizes{};
+    for (size_t i = 0; i < N; ++i) {
+        std::error_code error;
+        sizes[i] = std::filesystem::file_size(inputs[i], error);
+        if (error) {
+            result.status = ColumnStatus::IoError;
+            return result;
+        }
+        if (sizes[i] % sizeof(double) != 0 || sizes[i] != sizes[0]) {
+            result.status = ColumnStatus::SizeMismatch;
+            return result;
+        }
+        // also through a link: the mapped input would be cut under us
+        if (std::filesystem::equivalent(output, inputs[i], error)) {
+            result.status = ColumnStatus::OutputIsInput;
+            return result;
+        }
+    }
+    const size_t rows = N > 0 ? sizes[0] / sizeof(double) : 0;
+
+    std::array<utils::MappedFile, N> columns;
+    std::array<const double*, N> data{};
+    for (size_t i = 0; rows > 0 && i < N; ++i) {
+        columns[i] = utils::MappedFile{ inputs[i].c_str() };
+        if (!columns[i].valid()) {
+            result.status = ColumnStatus::IoError;
+            return result;
+        }
+        columns[i].sequential();
+        data[i] = reinterpret_cast<const double*>(columns[i].bytes().data());
+    }
+    auto sink = utils::MappedFile::create(output.c_str(), rows * sizeof(double));
+    if (rows == 0) {
+        // an empty output is still created
+        result.status = std::filesystem::exists(output) ? ColumnStatus::Ok : ColumnStatus::IoError;
+        return result;
+    }
+    if (!sink.valid()) {
+        result.status = ColumnStatus::IoError;
+        return result;
+    }
+    auto* const out = reinterpret_cast<double*>(sink.writable_bytes().data());
+
+    auto& pool = utils::default_thread_pool();
+    const size_t chunk = std::max<size_t>(1, options.chunk_rows);
+    const size_t window = chunk * (options.window_chunks ? options.window_chunks : 4 * pool.size());
+    const auto advise_inputs = [&](auto hint, size_t first, size_t count) {
+        for (auto& column : columns) {
+            (column.*hint)(first * sizeof(double), count * sizeof(double));
+        }
+    };
+
+    advise_inputs(&utils::MappedFile::will_need, 0, window);
+    for (size_t begin = 0; begin < rows; begin += window) {
+        const size_t end = std::min(rows, begin + window);
+        advise_inputs(&utils::MappedFile::will_need, end, window);
+
+        pool.parallel_for((end - begin + chunk - 1) / chunk, [&](size_t task) {
+            const size_t first = begin + task * chunk;
+            const size_t count = std::min(chunk, end - first);
+            std::array<const double*, N> in;
+            for (size_t i = 0; i < N; ++i) {
+                in[i] = data[i] + first;
+            }
+            detail::evaluate_rows<Policy>(f, std::span<double>(out + first, count), in,
+                                          std::make_index_sequence<N>{});
+        }, 1);
+
+        advise_inputs(&utils::MappedFile::dont_need, begin, end - begin);
+        sink.flush(begin * sizeof(double), (end - begin) * sizeof(double));
+        sink.dont_need(begin * sizeof(double), (end - begin) * sizeof(double));
+    }
+    result.rows = rows;
+    return result;
+}
+
+} // veritacpp::dsl::math
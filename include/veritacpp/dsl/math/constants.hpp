@@ -1,12 +1,15 @@
 #pragma once
 
 #include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/constexpr_math.hpp>
 
 
 namespace veritacpp::dsl::math { 
 
 template <Arithmetic auto C>
-struct Constant : BasicFunction {
+struct Constant : FunctionNode<Constant<C>> {
+    static constexpr uint64_t arity = 0;
+
     constexpr Arithmetic auto operator() (Arithmetic auto...) const {
         return C;
     }
@@ -42,7 +45,7 @@ constexpr auto operator - (Constant<C1>, Constant<C2>) {
 }
 template<Arithmetic auto C1, Arithmetic auto C2>
 constexpr auto operator ^ (Constant<C1>, Constant<C2>) {
-    return Constant<std::pow(C1,  C2)>{};
+    return Constant<constexpr_math::pow(C1,  C2)>{};
 }
 //------------------------------------------------------
 // simplification rules
@@ -114,7 +117,9 @@ constexpr auto operator ^ (Functional auto f, Constant<C>) {
 
 
 template <Arithmetic T>
-struct RTConstant : BasicFunction {
+struct RTConstant : FunctionNode<RTConstant<T>> {
+    static constexpr uint64_t arity = 0;
+
     const T value;
     explicit constexpr RTConstant(T val) : value(val) {} 
 
@@ -141,7 +146,7 @@ constexpr auto operator / (RTConstant<T1> c1, RTConstant<T2> c2) {
 }
 template<Arithmetic T1, Arithmetic T2>
 constexpr auto operator ^ (RTConstant<T1> c1, RTConstant<T2> c2) {
-    return RTConstant { std::pow(c1.value,  c2.value) };
+    return RTConstant { constexpr_math::pow(c1.value,  c2.value) };
 }
 
 
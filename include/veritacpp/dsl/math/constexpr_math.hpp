@@ -0,0 +1,381 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+
+/**
+ * Elementary functions usable in constant expressions on every compiler.
+ *
+ * constexpr_math::sin(x) etc. call std:: functions at runtime, and
+ * during constant evaluation compute the result in double-double
+ * arithmetic (~106 bits) and round it once. So constant folded values
+ * agree with runtime ones up to the rounding of the last bit,
+ * without relying on compiler builtins.
+ * Complex arguments always go to the std:: functions.
+ */
+namespace veritacpp::dsl::math::constexpr_math {
+
+namespace detail {
+
+// unevaluated sum hi + lo, |lo| <= ulp(hi) / 2
+struct DoubleDouble {
+    double hi = 0;
+    double lo = 0;
+};
+
+using DD = DoubleDouble;
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+constexpr DD kLn2 = { 0.6931471805599453, 2.3190468138462996e-17 };
+constexpr double kPio2[3] = { 1.5707963267948966, 6.123233995736766e-17,
+                              -1.4973849048591698e-33 };
+
+constexpr bool is_nan(double x) { return x != x; }
+constexpr bool is_inf(double x) { return x == kInf || x == -kInf; }
+constexpr double abs(double x) { return x < 0 ? -x : x; }
+
+constexpr double round(double x) {
+    return static_cast<double>(static_cast<int64_t>(x < 0 ? x - 0.5 : x + 0.5));
+}
+
+constexpr bool is_integral(double x) {
+    return abs(x) >= 0x1p52 || x == static_cast<double>(static_cast<int64_t>(x));
+}
+
+constexpr DD quick_two_sum(double a, double b) {
+    const double s = a + b;
+    return { s, b - (s - a) };
+}
+
+constexpr DD two_sum(double a, double b) {
+    const double s = a + b;
+    const double bb = s - a;
+    return { s, (a - (s - bb)) + (b - bb) };
+}
+
+// Dekker's splitting, scaled for large arguments
+constexpr DD split(double a) {
+    constexpr double kSplitter = 134217729.0; // 2^27 + 1
+    constexpr double kThreshold = 6.69692879491417e+299;
+    if (abs(a) > kThreshold) {
+        const auto [hi, lo] = split(a * 0x1p-28);
+        return { hi * 0x1p28, lo * 0x1p28 };
+    }
+    const double t = kSplitter * a;
+    const double hi = t - (t - a);
+    return { hi, a - hi };
+}
+
+constexpr DD two_prod(double a, double b) {
+    const double p = a * b;
+    if (is_inf(p) || is_nan(p)) {
+        return { p, 0 };
+    }
+    const auto [ah, al] = split(a);
+    const auto [bh, bl] = split(b);
+    return { p, ((ah * bh - p) + ah * bl + al * bh) + al * bl };
+}
+
+constexpr DD operator - (DD a) {
+    return { -a.hi, -a.lo };
+}
+
+constexpr DD operator + (DD a, DD b) {
+    DD s = two_sum(a.hi, b.hi);
+    const DD t = two_sum(a.lo, b.lo);
+    s = quick_two_sum(s.hi, s.lo + t.hi);
+    return quick_two_sum(s.hi, s.lo + t.lo);
+}
+
+constexpr DD operator - (DD a, DD b) {
+    return a + (-b);
+}
+
+constexpr DD operator * (DD a, DD b) {
+    DD p = two_prod(a.hi, b.hi);
+    if (is_inf(p.hi) || is_nan(p.hi)) {
+        return p;
+    }
+    return quick_two_sum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+}
+
+constexpr DD operator * (DD a, double b) {
+    return a * DD{ b, 0 };
+}
+
+constexpr DD operator / (DD a, DD b) {
+    const double q1 = a.hi / b.hi;
+    if (is_inf(q1) || is_nan(q1) || q1 == 0) {
+        return { q1, 0 };
+    }
+    DD r = a - b * q1;
+    const double q2 = r.hi / b.hi;
+    r = r - b * q2;
+    const double q3 = r.hi / b.hi;
+    return quick_two_sum(q1, q2) + DD{ q3, 0 };
+}
+
+// x * 2^k, exact unless the result is subnormal
+constexpr double ldexp(double x, int k) {
+    while (k > 1000) {
+        x *= 0x1p1000;
+        k -= 1000;
+    }
+    while (k < -1000) {
+        x *= 0x1p-1000;
+        k += 1000;
+    }
+    return x * std::bit_cast<double>(uint64_t(k + 1023) << 52);
+}
+
+constexpr DD ldexp(DD x, int k) {
+    return { ldexp(x.hi, k), ldexp(x.lo, k) };
+}
+
+// x = m * 2^e, m in [1, 2)
+constexpr double frexp(double x, int& e) {
+    e = 0;
+    if (x < 0x1p-1022) {
+        x *= 0x1p54;
+        e -= 54;
+    }
+    const auto bits = std::bit_cast<uint64_t>(x);
+    e += int((bits >> 52) & 0x7ff) - 1023;
+    return std::bit_cast<double>((bits & ((uint64_t(1) << 52) - 1)) | (uint64_t(1023) << 52));
+}
+
+constexpr DD exp(DD a) {
+    if (is_nan(a.hi)) {
+        return { kNaN, 0 };
+    }
+    if (a.hi > 709.8) {
+        return { kInf, 0 };
+    }
+    if (a.hi < -745.2) {
+        return { 0, 0 };
+    }
+    // a = k ln2 + r, |r| <= ln2 / 2, then r is scaled down by 2^10
+    const double k = round(a.hi / kLn2.hi);
+    const DD r = ldexp(a - kLn2 * k, -10);
+
+    // expm1(r) by Taylor series, |r| < 3.4e-4
+    DD term = r;
+    DD s = r;
+    for (int n = 2; n <= 11; ++n) {
+        term = term * r / DD{ double(n), 0 };
+        s = s + term;
+    }
+    // expm1(2r) = expm1(r) * (expm1(r) + 2)
+    for (int i = 0; i < 10; ++i) {
+        s = s * (s + DD{ 2, 0 });
+    }
+    return ldexp(s + DD{ 1, 0 }, int(k));
+}
+
+constexpr DD log(DD a) {
+    if (is_nan(a.hi) || a.hi < 0) {
+        return { kNaN, 0 };
+    }
+    if (a.hi == 0) {
+        return { -kInf, 0 };
+    }
+    if (is_inf(a.hi)) {
+        return a;
+    }
+    if (a.hi < 0x1p-900) {
+        // keep exp(-y) below in the range of double
+        return log(ldexp(a, 600)) - kLn2 * 600.0;
+    }
+    // double precision estimate: log(m) = 2 atanh(s), m in [sqrt(1/2), sqrt(2))
+    int e = 0;
+    double m = frexp(a.hi, e);
+    if (m > 1.4142135623730951) {
+        m /= 2;
+        e += 1;
+    }
+    const double s = (m - 1) / (m + 1);
+    const double s2 = s * s;
+    double p = 0;
+    for (int i = 12; i >= 0; --i) {
+        p = 1.0 / (2 * i + 1) + p * s2;
+    }
+    DD y = kLn2 * double(e) + DD{ 2 * s * p, 0 };
+
+    // Newton iterations for exp(y) = a
+    for (int i = 0; i < 2; ++i) {
+        y = y + (a * exp(-y) - DD{ 1, 0 });
+    }
+    return y;
+}
+
+// sin and cos of |r| <= pi/4 by Taylor series
+constexpr DD sin_taylor(DD r) {
+    const DD r2 = r * r;
+    DD term = r;
+    DD s = r;
+    for (int n = 3; n <= 29; n += 2) {
+        term = -(term * r2 / DD{ double((n - 1) * n), 0 });
+        s = s + term;
+    }
+    return s;
+}
+
+constexpr DD cos_taylor(DD r) {
+    const DD r2 = r * r;
+    DD term = { 1, 0 };
+    DD s = term;
+    for (int n = 2; n <= 28; n += 2) {
+        term = -(term * r2 / DD{ double((n - 1) * n), 0 });
+        s = s + term;
+    }
+    return s;
+}
+
+// x = r + quadrant * pi/2; accurate while |x| < 2^40
+constexpr DD reduce_pio2(DD x, int64_t& quadrant) {
+    const double k = round(x.hi / kPio2[0]);
+    quadrant = static_cast<int64_t>(k);
+    return ((x - two_prod(k, kPio2[0])) - two_prod(k, kPio2[1])) - DD{ k * kPio2[2], 0 };
+}
+
+constexpr DD sin(DD x, bool cosine) {
+    if (is_nan(x.hi) || is_inf(x.hi)) {
+        return { kNaN, 0 };
+    }
+    if (abs(x.hi) < 0x1p-27) {
+        return cosine ? DD{ 1, 0 } : x;
+    }
+    int64_t quadrant = 0;
+    const DD r = reduce_pio2(x, quadrant);
+    switch (((quadrant % 4) + 4 + (cosine ? 1 : 0)) % 4) {
+        case 0: return sin_taylor(r);
+        case 1: return cos_taylor(r);
+        case 2: return -sin_taylor(r);
+        default: return -cos_taylor(r);
+    }
+}
+
+constexpr DD pow(DD x, double y) {
+    if (y == 0 || x.hi == 1) {
+        return { 1, 0 };
+    }
+    if (is_nan(x.hi) || is_nan(y)) {
+        return { kNaN, 0 };
+    }
+    const bool integral = is_integral(y);
+    const bool odd = integral && abs(y) < 0x1p53 &&
+                     static_cast<int64_t>(y) % 2 != 0;
+    if (x.hi == 0 || is_inf(x.hi)) {
+        const bool large = is_inf(x.hi) == (y > 0);
+        const double r = large ? kInf : 0;
+        return { (odd && std::bit_cast<uint64_t>(x.hi) >> 63) ? -r : r, 0 };
+    }
+    if (x.hi < 0) {
+        if (!integral) {
+            return { kNaN, 0 };
+        }
+        const DD r = pow(-x, y);
+        return odd ? -r : r;
+    }
+    if (integral && abs(y) < 0x1p30) {
+        // exponentiation by squaring
+        auto n = static_cast<int64_t>(abs(y));
+        DD r = { 1, 0 };
+        DD base = x;
+        while (n > 0) {
+            if (n % 2) {
+                r = r * base;
+            }
+            base = base * base;
+            n /= 2;
+        }
+        return y < 0 ? DD{ 1, 0 } / r : r;
+    }
+    return exp(log(x) * y);
+}
+
+template <class T>
+constexpr DD to_dd(T x) {
+    const double hi = static_cast<double>(x);
+    return { hi, static_cast<double>(x - static_cast<T>(hi)) };
+}
+
+template <class R>
+constexpr R from_dd(DD x) {
+    if constexpr (sizeof(R) > sizeof(double)) {
+        return static_cast<R>(x.hi) + static_cast<R>(x.lo);
+    } else {
+        return static_cast<R>(x.hi + x.lo);
+    }
+}
+
+template <class T>
+using Floating = std::conditional_t<std::floating_point<T>, T, double>;
+
+} // namespace detail
+
+
+template <Arithmetic X>
+constexpr auto sin(X x) {
+    if constexpr (Complex<X>) {
+        return std::sin(x);
+    } else if (std::is_constant_evaluated()) {
+        using R = detail::Floating<X>;
+        return detail::from_dd<R>(detail::sin(detail::to_dd<R>(x), false));
+    }
+    return std::sin(x);
+}
+
+template <Arithmetic X>
+constexpr auto cos(X x) {
+    if constexpr (Complex<X>) {
+        return std::cos(x);
+    } else if (std::is_constant_evaluated()) {
+        using R = detail::Floating<X>;
+        return detail::from_dd<R>(detail::sin(detail::to_dd<R>(x), true));
+    }
+    return std::cos(x);
+}
+
+template <Arithmetic X>
+constexpr auto exp(X x) {
+    if constexpr (Complex<X>) {
+        return std::exp(x);
+    } else if (std::is_constant_evaluated()) {
+        using R = detail::Floating<X>;
+        return detail::from_dd<R>(detail::exp(detail::to_dd<R>(x)));
+    }
+    return std::exp(x);
+}
+
+template <Arithmetic X>
+constexpr auto log(X x) {
+    if constexpr (Complex<X>) {
+        return std::log(x);
+    } else if (std::is_constant_evaluated()) {
+        using R = detail::Floating<X>;
+        return detail::from_dd<R>(detail::log(detail::to_dd<R>(x)));
+    }
+    return std::log(x);
+}
+
+template <Arithmetic X, Arithmetic Y>
+constexpr auto pow(X x, Y y) {
+    if constexpr (Complex<X> || Complex<Y>) {
+        return std::pow(x, y);
+    } else if (std::is_constant_evaluated()) {
+        using R = decltype(std::pow(x, y));
+        return detail::from_dd<R>(detail::pow(detail::to_dd<R>(x), static_cast<double>(y)));
+    }
+    return std::pow(x, y);
+}
+
+} // namespace veritacpp::dsl::math::constexpr_math
@@ -1,31 +1,156 @@
 #pragma once
 
 #include <concepts>
+#include <complex>
 #include <type_traits>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <utility>
 
 namespace veritacpp::dsl::math {
 
 struct BasicFunction {};
 
-template <class T>
-concept Functional = std::is_base_of_v<BasicFunction, T>;
+/**
+ * Marker base for the library's own nodes.
+ * Unlike BasicFunction it is a distinct type for every node, so a node's
+ * marker never collides with the markers of its children and stateless
+ * children can be laid out at zero size.
+ */
+template <class Node>
+struct FunctionNode {};
 
 template <class T>
-concept Arithmetic = std::is_arithmetic_v<T>;
+concept Functional = std::is_base_of_v<BasicFunction, T> ||
+                     std::is_base_of_v<FunctionNode<T>, T>;
 
 namespace detail {
 
+template <class T>
+struct IsComplex : std::false_type {};
+
+template <class T>
+struct IsComplex<std::complex<T>> : std::true_type {};
+
+} // namespace detail
+
+template <class T>
+concept Complex = detail::IsComplex<T>::value;
+
+// ordered numbers: the values of min, max, clamp and select
+template <class T>
+concept Real = std::is_arithmetic_v<T>;
+
+template <class T>
+concept Arithmetic = Real<T> || Complex<T>;
+
+/**
+ * std::complex<T> only mixes with T, but constants of expressions and
+ * derivatives are often integers (kOne, exponents of Pow): complex
+ * values combine with any real number, converted to T.
+ */
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator + (const std::complex<T>& a, U b) { return a + T(b); }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator + (U a, const std::complex<T>& b) { return T(a) + b; }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator - (const std::complex<T>& a, U b) { return a - T(b); }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator - (U a, const std::complex<T>& b) { return T(a) - b; }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator * (const std::complex<T>& a, U b) { return a * T(b); }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator * (U a, const std::complex<T>& b) { return T(a) * b; }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator / (const std::complex<T>& a, U b) { return a / T(b); }
+
+template <class T, Real U>
+requires (!std::same_as<T, U>)
+constexpr std::complex<T> operator / (U a, const std::complex<T>& b) { return T(a) / b; }
+
+/**
+ * Functional without any runtime payload:
+ * can be rebuilt from nothing instead of being stored
+ */
+template <class T>
+concept StatelessFunctional = Functional<T> && std::is_empty_v<T> &&
+                              std::is_default_constructible_v<T>;
+
+namespace detail {
 
 template <uint64_t N, class F>
 constexpr bool is_invocable_with_N_arithmetics = []<uint64_t... idx>(
         std::integer_sequence<uint64_t, idx...>){
         return std::is_invocable_v<F, decltype(static_cast<float>(idx))...>;
     }(std::make_index_sequence<N>{});
+
+template <class F>
+concept DeclaresArity = requires {
+    { F::arity } -> std::convertible_to<uint64_t>;
+};
+
+// functions beyond this many variables are not probed for
+constexpr uint64_t kMaxProbedArity = 16;
+
+template <class F, uint64_t N = 0>
+constexpr uint64_t probed_arity() {
+    if constexpr (N == kMaxProbedArity || is_invocable_with_N_arithmetics<N, F>) {
+        return N;
+    } else {
+        return probed_arity<F, N + 1>();
+    }
 }
 
+} // namespace detail
+
+/**
+ * Number of arguments a function needs: the largest index of its
+ * variables plus one. Nodes declare it as a static member arity,
+ * built from the arities of their children, so checking a call
+ * does not instantiate the call operators of the whole tree.
+ * Other functions are probed once with float arguments.
+ */
+template <class F>
+constexpr uint64_t arity_v = [] {
+    if constexpr (detail::DeclaresArity<F>) {
+        return uint64_t(F::arity);
+    } else {
+        return detail::probed_arity<F>();
+    }
+}();
+
+namespace detail {
+
+// arity of a node evaluating all its children on its own arguments
+template <class... Fs>
+constexpr uint64_t max_arity = std::max({ uint64_t(0), arity_v<Fs>... });
+
+template <uint64_t N, class F>
+constexpr bool accepts_n_variables() {
+    if constexpr (DeclaresArity<F>) {
+        return N >= F::arity;
+    } else {
+        return is_invocable_with_N_arithmetics<N, F>;
+    }
+}
+
+} // namespace detail
+
 template <uint64_t N, class T>
-concept NVariablesFunctional = Functional<T> && detail::is_invocable_with_N_arithmetics<N, T>;
-    
+concept NVariablesFunctional = Functional<T> && detail::accepts_n_variables<N, T>();
 
-} // veritacpp::dsl::math
\ No newline at end of file
+} // veritacpp::dsl::math
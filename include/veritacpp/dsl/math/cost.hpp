@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+#include <veritacpp/dsl/math/tabulated.hpp>
+
+/**
+ * Static cost model of expressions.
+ *
+ * cost_v<F> counts the work of one evaluation of F, derived from its type
+ * alone: arithmetic operations, calls of elementary functions and nodes
+ * of the tree. Stored children are part of the type as well, so the
+ * model covers runtime constants and tables too.
+ * Compare e.g. cost_v<decltype(diff(f, x))> with cost_v<decltype(f)>
+ * to see how much work differentiation added.
+ */
+namespace veritacpp::dsl::math {
+
+struct Cost {
+    uint64_t flops = 0;           // +, -, *, / and negation
+    uint64_t transcendentals = 0; // sin, cos, exp, log, non-integral pow
+    uint64_t nodes = 0;
+
+    constexpr bool operator == (const Cost&) const = default;
+};
+
+constexpr Cost operator + (const Cost& a, const Cost& b) {
+    return { a.flops + b.flops, a.transcendentals + b.transcendentals,
+             a.nodes + b.nodes };
+}
+
+/**
+ * Cost of a single node including its children.
+ * Functionals the model does not know are opaque: one node, no operations.
+ * Specialize it for your own nodes.
+ */
+template <class F>
+struct NodeCost {
+    static constexpr Cost value = { 0, 0, 1 };
+};
+
+template <class F>
+constexpr Cost cost_v = NodeCost<std::remove_cvref_t<F>>::value;
+
+namespace detail {
+
+template <Functional... Fs>
+constexpr Cost kChildrenCost = (Cost{} + ... + cost_v<Fs>);
+
+// multiplications of exponentiation by squaring
+constexpr uint64_t squaring_multiplications(uint64_t n) {
+    uint64_t count = 0;
+    for (; n > 1; n /= 2) {
+        count += n % 2 ? 2 : 1;
+    }
+    return count;
+}
+
+} // namespace detail
+
+template <Functional F>
+struct NodeCost<Negate<F>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + cost_v<F>;
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Add<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Sub<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Mul<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Div<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional... Fs>
+struct NodeCost<Sum<Fs...>> {
+    static constexpr Cost value = Cost{ sizeof...(Fs) - 1, 0, 1 } +
+                                  detail::kChildrenCost<Fs...>;
+};
+
+template <Functional... Fs>
+struct NodeCost<Product<Fs...>> {
+    static constexpr Cost value = Cost{ sizeof...(Fs) - 1, 0, 1 } +
+                                  detail::kChildrenCost<Fs...>;
+};
+
+template <Functional F, Functional... Gs>
+struct NodeCost<App<F, Gs...>> {
+    static constexpr Cost value = Cost{ 0, 0, 1 } + detail::kChildrenCost<F, Gs...>;
+};
+
+// integral exponents are expanded into multiplications, as FastMath does
+template <Arithmetic auto C>
+struct NodeCost<Pow<C>> {
+    static constexpr Cost value = [] {
+        if constexpr (C == static_cast<int64_t>(C)) {
+            constexpr auto n = static_cast<int64_t>(C);
+            return Cost{ detail::squaring_multiplications(n < 0 ? -n : n) + (n < 0), 0, 1 };
+        } else {
+            return Cost{ 0, 1, 1 };
+        }
+    }();
+};
+
+template <Arithmetic T>
+struct NodeCost<RTPow<T>> {
+    static constexpr Cost value = { 0, 1, 1 };
+};
+
+template <>
+struct NodeCost<Sin> {
+    static constexpr Cost value = { 0, 1, 1 };
+};
+
+template <>
+struct NodeCost<Cos> {
+    static constexpr Cost value = { 0, 1, 1 };
+};
+
+template <>
+struct NodeCost<Exp> {
+    static constexpr Cost value = { 0, 1, 1 };
+};
+
+template <>
+struct NodeCost<Log> {
+    static constexpr Cost value = { 0, 1, 1 };
+};
+
+// comparisons and selects count as flops: one instruction each in vector code
+
+template <>
+struct NodeCost<Abs> {
+    static constexpr Cost value = { 1, 0, 1 };
+};
+
+template <>
+struct NodeCost<Sign> {
+    static constexpr Cost value = { 2, 0, 1 };
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Min<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional F1, Functional F2>
+struct NodeCost<Max<F1, F2>> {
+    static constexpr Cost value = Cost{ 1, 0, 1 } + detail::kChildrenCost<F1, F2>;
+};
+
+template <Functional F, Functional Lo, Functional Hi>
+struct NodeCost<Clamp<F, Lo, Hi>> {
+    static constexpr Cost value = Cost{ 2, 0, 1 } + detail::kChildrenCost<F, Lo, Hi>;
+};
+
+template <Functional Cond, Functional F, Functional G>
+struct NodeCost<Select<Cond, F, G>> {
+    static constexpr Cost value = Cost{ 2, 0, 1 } + detail::kChildrenCost<Cond, F, G>;
+};
+
+namespace detail {
+
+// locating the cell and evaluating the piece, see detail::interpolate
+template <Interpolation I>
+constexpr Cost kInterpolationCost = { I == Interpolation::Cubic ? 17 : 6, 0, 1 };
+
+} // namespace detail
+
+template <size_t N, Interpolation I, unsigned Order>
+struct NodeCost<Tabulated<N, I, Order>> {
+    static constexpr Cost value = detail::kInterpolationCost<I>;
+};
+
+template <Interpolation I, unsigned Order>
+struct NodeCost<RTTabulated<I, Order>> {
+    static constexpr Cost value = detail::kInterpolationCost<I>;
+};
+
+} // veritacpp::dsl::math
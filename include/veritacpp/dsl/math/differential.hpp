@@ -52,7 +52,7 @@ constexpr Functional auto diff(Variable<N>, Variable<M>) {
 
 template<Functional F, DifferentialVariable X>
 constexpr Functional auto diff(Negate<F> nf, X x) {
-    return -diff(nf.f, x);
+    return -diff(nf.f(), x);
 }
 
 
@@ -60,25 +60,54 @@ constexpr Functional auto diff(Negate<F> nf, X x) {
 
 template<Functional A, Functional B, DifferentialVariable X>
 constexpr Functional auto diff(Add<A, B> s, X x) {
-    return diff(s.f1, x) + diff(s.f2, x);
+    return diff(s.f1(), x) + diff(s.f2(), x);
 }
 
 
 template<Functional A, Functional B, DifferentialVariable X>
 constexpr Functional auto diff(Sub<A, B> s, X x) {
-    return diff(s.f1, x) - diff(s.f2, x);
+    return diff(s.f1(), x) - diff(s.f2(), x);
 }
 
 
 template <Functional F1, Functional F2, DifferentialVariable X>
 constexpr Functional auto diff(Mul<F1, F2> m, X x) { 
-    return diff(m.f1, x) * m.f2 + m.f1 * diff(m.f2, x);
+    return diff(m.f1(), x) * m.f2() + m.f1() * diff(m.f2(), x);
 };
 
 
+template <Functional... Fs, DifferentialVariable X>
+constexpr Functional auto diff(Sum<Fs...> s, X x) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return sum_of(diff(s.template term<idx>(), x)...);
+    }(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+
+// sum over i of products with i-th factor differentiated
+template <Functional... Fs, DifferentialVariable X>
+constexpr Functional auto diff(Product<Fs...> p, X x) {
+    constexpr auto seq = std::make_index_sequence<sizeof...(Fs)>{};
+    const auto factor = [&]<uint64_t i, uint64_t j>() {
+        if constexpr (i == j) {
+            return diff(p.template term<j>(), x);
+        } else {
+            return p.template term<j>();
+        }
+    };
+    const auto product_i = [&]<uint64_t i, uint64_t... j>(
+            std::integral_constant<uint64_t, i>, std::integer_sequence<uint64_t, j...>) {
+        return product_of(factor.template operator()<i, j>()...);
+    };
+    return [&]<uint64_t... i>(std::integer_sequence<uint64_t, i...>) {
+        return sum_of(product_i(std::integral_constant<uint64_t, i>{}, seq)...);
+    }(seq);
+}
+
+
 template <Functional F1, Functional F2, DifferentialVariable X>
 constexpr Functional auto diff(Div<F1, F2> d, X x) { 
-    return (diff(d.f1, x) * d.f2 - d.f1 * diff(d.f2, x)) / (d.f2 * d.f2);
+    return (diff(d.f1(), x) * d.f2() - d.f1() * diff(d.f2(), x)) / (d.f2() * d.f2());
 };
 
 
@@ -120,8 +149,8 @@ static constexpr Functional auto apply_chain_rule(F f, X x, Gs... gs) {
 template <Functional F, Functional... Gs, DifferentialVariable X>
 constexpr Functional auto diff(App<F, Gs...> ap, X x) {
     return std::apply([&](Gs... gs){
-         return detail::apply_chain_rule(ap.f, x, gs...);
-    },  ap.gs);
+         return detail::apply_chain_rule(ap.f(), x, gs...);
+    },  ap.gs());
 };
 
 
@@ -129,53 +158,95 @@ constexpr Functional auto diff(App<F, Gs...> ap, X x) {
 
 template <Arithmetic auto C, uint64_t xid>
 constexpr Functional auto diff(Pow<C>, Variable<xid>) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0 || C == 0) {
         return kZero;
+    } else {
+        return Constant<C>{} * Pow<C - 1>{};
     }
-    if constexpr (C == 0) {
-        return kOne;
-    }
-    return Constant<C>{} * Pow<C - 1>{};
 }
 
 
 template <Arithmetic T, uint64_t xid>
 constexpr Functional auto diff(RTPow<T> pw, Variable<xid>) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0) {
         return kZero;
+    } else {
+        return pw.deg * RTPow(RTConstant<T>{pw.deg() - 1});
     }
-    return  pw.deg * RTPow(RTConstant<T>{pw.deg() - 1});
 }
 
 
 template <uint64_t xid>
 constexpr Functional auto diff(Sin, Variable<xid>) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0) {
         return kZero;
+    } else {
+        return Cos{};
     }
-    return Cos{};
 }
 template <uint64_t xid>
 constexpr Functional auto diff(Cos, Variable<xid>) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0) {
         return kZero;
+    } else {
+        return -Sin{};
     }
-    return -Sin{};
 }
 
 template <uint64_t xid>
 constexpr Functional auto diff(Exp, Variable<xid>) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0) {
         return kZero;
+    } else {
+        return Exp{};
     }
-    return Exp{};
 }
 template <uint64_t xid>
 constexpr Functional auto diff(Log, Variable<xid> x) {
-    if constexpr(xid != 0) {
+    if constexpr (xid != 0) {
         return kZero;
+    } else {
+        return kOne / x;
     }
-    return kOne / x;
+}
+
+// subgradient: 0 at the kink
+template <uint64_t xid>
+constexpr Functional auto diff(Abs, Variable<xid>) {
+    if constexpr (xid != 0) {
+        return kZero;
+    } else {
+        return Sign{};
+    }
+}
+
+template <uint64_t xid>
+constexpr Functional auto diff(Sign, Variable<xid>) {
+    return kZero;
+}
+
+// piecewise nodes: the derivative of the selected piece,
+// selected by the same condition as the value
+
+template <Functional F1, Functional F2, DifferentialVariable X>
+constexpr Functional auto diff(Min<F1, F2> m, X x) {
+    return select(m.f1() - m.f2(), diff(m.f2(), x), diff(m.f1(), x));
+}
+
+template <Functional F1, Functional F2, DifferentialVariable X>
+constexpr Functional auto diff(Max<F1, F2> m, X x) {
+    return select(m.f2() - m.f1(), diff(m.f2(), x), diff(m.f1(), x));
+}
+
+template <Functional F, Functional Lo, Functional Hi, DifferentialVariable X>
+constexpr Functional auto diff(Clamp<F, Lo, Hi> c, X x) {
+    return select(c.lo() - c.f(), diff(c.lo(), x),
+                  select(c.f() - c.hi(), diff(c.hi(), x), diff(c.f(), x)));
+}
+
+template <Functional Cond, Functional F, Functional G, DifferentialVariable X>
+constexpr Functional auto diff(Select<Cond, F, G> s, X x) {
+    return select(s.cond(), diff(s.f(), x), diff(s.g(), x));
 }
 
 
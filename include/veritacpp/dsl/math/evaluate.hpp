@@ -0,0 +1,354 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <tuple>
+#include <utility>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+#include <veritacpp/dsl/math/constexpr_math.hpp>
+#include <veritacpp/dsl/math/fast_math.hpp>
+
+#include <veritacpp/utils/tuple.hpp>
+
+/**
+ * Evaluation of expressions under a policy.
+ *
+ * evaluate<Policy>(f, x...) walks the expression tree the same way
+ * f(x...) does, but every elementary function node (Sin, Cos, Exp, Log,
+ * Pow) is computed by the policy's kernel. Nodes the evaluator does not
+ * know about are called directly.
+ */
+namespace veritacpp::dsl::math {
+
+/**
+ * Standard library kernels (constexpr_math.hpp): same results as calling
+ * the expression
+ */
+struct Precise {
+    static constexpr auto sin(auto x) { return constexpr_math::sin(x); }
+    static constexpr auto cos(auto x) { return constexpr_math::cos(x); }
+    static constexpr auto exp(auto x) { return constexpr_math::exp(x); }
+    static constexpr auto log(auto x) { return constexpr_math::log(x); }
+
+    template <Arithmetic auto C>
+    static constexpr auto pow(auto x) { return constexpr_math::pow(x, C); }
+
+    static constexpr auto pow(auto x, auto c) { return constexpr_math::pow(x, c); }
+};
+
+/**
+ * Polynomial kernels from fast_math.hpp with degrees chosen so that
+ * truncation error of every kernel stays below Tolerance:
+ * relative for exp and log, absolute for sin and cos.
+ * Integral arguments are computed in double. Complex arguments have
+ * no polynomial kernels and use the standard library.
+ * Pow with an integral constant exponent is expanded into multiplications,
+ * other powers are computed as exp(c * log(x)) and require x > 0.
+ */
+template <double Tolerance>
+struct FastMath {
+    static_assert(Tolerance > 0, "tolerance should be positive");
+
+    static constexpr int kExpDegree = fast::exp_degree(Tolerance);
+    static constexpr int kLogTerms = fast::log_terms(Tolerance);
+    static constexpr int kSinDegree = fast::sin_degree(Tolerance);
+    static constexpr int kCosDegree = fast::cos_degree(Tolerance);
+
+    static constexpr auto sin(auto x) {
+        if constexpr (Complex<decltype(x)>) {
+            return constexpr_math::sin(x);
+        } else {
+            return fast::sin<kSinDegree, kCosDegree>(floating(x));
+        }
+    }
+    static constexpr auto cos(auto x) {
+        if constexpr (Complex<decltype(x)>) {
+            return constexpr_math::cos(x);
+        } else {
+            return fast::cos<kSinDegree, kCosDegree>(floating(x));
+        }
+    }
+    static constexpr auto exp(auto x) {
+        if constexpr (Complex<decltype(x)>) {
+            return constexpr_math::exp(x);
+        } else {
+            return fast::exp<kExpDegree>(floating(x));
+        }
+    }
+    static constexpr auto log(auto x) {
+        if constexpr (Complex<decltype(x)>) {
+            return constexpr_math::log(x);
+        } else {
+            return fast::log<kLogTerms>(floating(x));
+        }
+    }
+
+    template <Arithmetic auto C>
+    static constexpr auto pow(auto x) {
+        if constexpr (C == static_cast<int64_t>(C)) {
+            constexpr auto n = static_cast<int64_t>(C);
+            const auto p = integral_pow<(n < 0 ? -n : n)>(floating(x));
+            return n < 0 ? 1 / p : p;
+        } else {
+            return pow(x, C);
+        }
+    }
+
+    static constexpr auto pow(auto x, auto c) {
+        const auto fx = floating(x);
+        return exp(static_cast<decltype(fx)>(c) * log(fx));
+    }
+
+private:
+    template <Arithmetic X>
+    static constexpr auto floating(X x) {
+        if constexpr (std::floating_point<X> || Complex<X>) {
+            return x;
+        } else {
+            return static_cast<double>(x);
+        }
+    }
+
+    // exponentiation by squaring, unrolled at compile time
+    template <uint64_t N>
+    static constexpr auto integral_pow(auto x) {
+        if constexpr (N == 0) {
+            return decltype(x)(1);
+        } else if constexpr (N == 1) {
+            return x;
+        } else {
+            const auto half = integral_pow<N / 2>(x);
+            if constexpr (N % 2) {
+                return half * half * x;
+            } else {
+                return half * half;
+            }
+        }
+    }
+};
+
+namespace detail {
+
+/**
+ * Lives on the stack of evaluate() while a node is being evaluated.
+ * It is empty for ordinary policies and optimized away;
+ * Profiled<Policy> (profile.hpp) specializes it to take measurements.
+ */
+template <class Policy, class Node>
+struct EvaluationScope {
+    constexpr EvaluationScope() {}
+};
+
+template <class Policy, class Node>
+constexpr EvaluationScope<Policy, Node> enter(const Node&) {
+    return {};
+}
+
+} // namespace detail
+
+
+// any other functional: call it directly
+template <class Policy = Precise, Functional F, class... X>
+constexpr auto evaluate(const F& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return f(x...);
+}
+
+template <class Policy = Precise, uint64_t N, class... X>
+constexpr auto evaluate(Variable<N> v, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(v);
+    static_assert(sizeof...(X) > N, "not enough arguments");
+    return std::get<N>(std::make_tuple(x...));
+}
+
+template <class Policy = Precise, Arithmetic auto C, class... X>
+constexpr auto evaluate(Constant<C> c, X...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(c);
+    return C;
+}
+
+template <class Policy = Precise, Arithmetic T, class... X>
+constexpr auto evaluate(const RTConstant<T>& c, X...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(c);
+    return c.value;
+}
+
+template <class Policy = Precise, Functional F, class... X>
+constexpr auto evaluate(const Negate<F>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return -evaluate<Policy>(f.f(), x...);
+}
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Add<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return evaluate<Policy>(f.f1(), x...) + evaluate<Policy>(f.f2(), x...);
+}
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Sub<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return evaluate<Policy>(f.f1(), x...) - evaluate<Policy>(f.f2(), x...);
+}
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Mul<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return evaluate<Policy>(f.f1(), x...) * evaluate<Policy>(f.f2(), x...);
+}
+
+template <class Policy = Precise, Functional... Fs, class... X>
+constexpr auto evaluate(const Sum<Fs...>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        using R = std::common_type_t<decltype(evaluate<Policy>(f.template term<idx>(), x...))...>;
+        return detail::pairwise_reduce(std::array<R, sizeof...(Fs)>{
+            static_cast<R>(evaluate<Policy>(f.template term<idx>(), x...))... }, std::plus<>{});
+    }(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+template <class Policy = Precise, Functional... Fs, class... X>
+constexpr auto evaluate(const Product<Fs...>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        using R = std::common_type_t<decltype(evaluate<Policy>(f.template term<idx>(), x...))...>;
+        return detail::pairwise_reduce(std::array<R, sizeof...(Fs)>{
+            static_cast<R>(evaluate<Policy>(f.template term<idx>(), x...))... }, std::multiplies<>{});
+    }(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Div<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return evaluate<Policy>(f.f1(), x...) /
+           detail::divisor(evaluate<Policy>(f.f2(), x...));
+}
+
+template <class Policy = Precise, Functional F, Functional... Gs, class... X>
+constexpr auto evaluate(const App<F, Gs...>& ap, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(ap);
+    const auto xs = utils::forward_as_view(x...);
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return utils::apply([&ap](auto... args) {
+            return evaluate<Policy>(ap.f(), args...);
+        }, utils::concat(utils::forward_as_view(evaluate<Policy>(ap.template g<idx>(), x...)...),
+                         utils::split<sizeof...(Gs)>(xs).second));
+    }(std::make_index_sequence<sizeof...(Gs)>{});
+}
+
+template <class Policy = Precise, Arithmetic auto C, class X, class... Xs>
+constexpr auto evaluate(Pow<C> p, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(p);
+    return Policy::template pow<C>(x);
+}
+
+template <class Policy = Precise, Arithmetic T, class X, class... Xs>
+constexpr auto evaluate(const RTPow<T>& p, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(p);
+    return Policy::pow(x, p.deg());
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Sin f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return Policy::sin(x);
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Cos f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return Policy::cos(x);
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Exp f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return Policy::exp(x);
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Log f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return Policy::log(x);
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Abs f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return f(x);
+}
+
+template <class Policy = Precise, class X, class... Xs>
+constexpr auto evaluate(Sign f, X x, Xs...) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    return f(x);
+}
+
+// piecewise nodes evaluate every piece, then select without branching
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Min<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    const auto a = evaluate<Policy>(f.f1(), x...);
+    const auto b = evaluate<Policy>(f.f2(), x...);
+    return b < a ? b : a;
+}
+
+template <class Policy = Precise, Functional F1, Functional F2, class... X>
+constexpr auto evaluate(const Max<F1, F2>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    const auto a = evaluate<Policy>(f.f1(), x...);
+    const auto b = evaluate<Policy>(f.f2(), x...);
+    return a < b ? b : a;
+}
+
+template <class Policy = Precise, Functional F, Functional Lo, Functional Hi, class... X>
+constexpr auto evaluate(const Clamp<F, Lo, Hi>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    const auto v = evaluate<Policy>(f.f(), x...);
+    const auto l = evaluate<Policy>(f.lo(), x...);
+    const auto h = evaluate<Policy>(f.hi(), x...);
+    return v < l ? l : (h < v ? h : v);
+}
+
+template <class Policy = Precise, Functional Cond, Functional F, Functional G, class... X>
+constexpr auto evaluate(const Select<Cond, F, G>& f, X... x) {
+    [[maybe_unused]] const auto scope = detail::enter<Policy>(f);
+    const auto c = evaluate<Policy>(f.cond(), x...);
+    const auto a = evaluate<Policy>(f.f(), x...);
+    const auto b = evaluate<Policy>(f.g(), x...);
+    return c > 0 ? a : b;
+}
+
+
+/**
+ * Evaluates f at every point of the input ranges:
+ *   out[i] = evaluate<Policy>(f, in[i]...)
+ * Each input range should contain at least size(out) elements.
+ * The loop has no dependencies between iterations, and with branchless
+ * kernels (FastMath) the compiler emits vector code for it.
+ */
+template <class Policy = Precise, Functional F,
+          std::ranges::contiguous_range Out,
+          std::ranges::contiguous_range... In>
+constexpr void evaluate_batch(const F& f, Out&& out, const In&... in) {
+    const auto n = std::ranges::size(out);
+    assert(((std::ranges::size(in) >= n) && ...));
+    auto* const dst = std::ranges::data(out);
+    [&](const auto* const... src) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = evaluate<Policy>(f, src[i]...);
+        }
+    }(std::ranges::data(in)...);
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <array>
+
+/**
+ * Branch-light polynomial approximations of elementary functions.
+ *
+ * Every kernel reduces its argument to a short interval with bit
+ * manipulations and evaluates a truncated series there with Horner's
+ * scheme. There are no data-dependent branches (only selects), so loops
+ * over arrays of arguments are vectorized by the compiler.
+ *
+ * The degree of each polynomial is a template parameter;
+ * *_degree(tolerance) functions choose the smallest degree whose
+ * truncation error does not exceed the tolerance. Bounds below do not
+ * include rounding errors of the floating point type itself (a few ulp).
+ */
+namespace veritacpp::dsl::math::fast {
+
+namespace detail {
+
+template <std::floating_point T>
+struct FloatLayout;
+
+template <>
+struct FloatLayout<float> {
+    using Bits = uint32_t;
+    static constexpr int kMantissa = 23;
+    static constexpr int kBias = 127;
+    // ln(2) and pi/2 splitted so that k * hi is exact
+    static constexpr float kLn2Hi = 0.693145751953125f;
+    static constexpr float kLn2Lo = 1.428606765330187045e-06f;
+    static constexpr float kPio2[3] = { 1.5703125f, 4.837512969970703125e-4f,
+                                        7.54978995489188216e-8f };
+};
+
+template <>
+struct FloatLayout<double> {
+    using Bits = uint64_t;
+    static constexpr int kMantissa = 52;
+    static constexpr int kBias = 1023;
+    static constexpr double kLn2Hi = 6.93147180369123816490e-01;
+    static constexpr double kLn2Lo = 1.90821492927058770002e-10;
+    static constexpr double kPio2[3] = { 1.57079632673412561417e+00,
+                                         6.07710050650619224932e-11,
+                                         2.02226624879595063154e-21 };
+};
+
+constexpr double kLog2E = 1.44269504088896340736;
+constexpr double kTwoOverPi = 0.63661977236758134308;
+constexpr double kSqrt2 = 1.41421356237309504880;
+
+// 1.5 * 2^mantissa: adding it rounds to integer, the integer is kept in low bits
+template <std::floating_point T>
+constexpr T kRoundShifter = T(3) * T(uint64_t(1) << (FloatLayout<T>::kMantissa - 1));
+
+template <std::floating_point T>
+constexpr T pow2_from_shifted(typename FloatLayout<T>::Bits shifted_k) {
+    using L = FloatLayout<T>;
+    using Bits = typename L::Bits;
+    return std::bit_cast<T>(Bits(shifted_k + Bits(L::kBias)) << L::kMantissa);
+}
+
+// converts integer v < 2^mantissa without int -> float instructions,
+// which do not vectorize for 64-bit integers
+template <std::floating_point T>
+constexpr T small_to_float(typename FloatLayout<T>::Bits v) {
+    constexpr T two_pow_mantissa = T(uint64_t(1) << FloatLayout<T>::kMantissa);
+    using Bits = typename FloatLayout<T>::Bits;
+    return std::bit_cast<T>(v | std::bit_cast<Bits>(two_pow_mantissa)) - two_pow_mantissa;
+}
+
+constexpr double inverse_factorial(int n) {
+    double r = 1;
+    for (int i = 2; i <= n; ++i) {
+        r /= i;
+    }
+    return r;
+}
+
+/**
+ * Taylor coefficients c[i] of the series sum c[i] * x^(First + Step * i),
+ * Sign alternates the signs of consecutive terms.
+ * Computed once per instantiation, so loops over them fold into constants.
+ */
+template <int First, int Step, int Count, bool Sign>
+constexpr std::array<double, Count> kTaylorCoefficients = [] {
+    std::array<double, Count> c{};
+    for (int i = 0; i < Count; ++i) {
+        c[i] = (Sign && i % 2) ? -inverse_factorial(First + Step * i)
+                               : inverse_factorial(First + Step * i);
+    }
+    return c;
+}();
+
+// Horner scheme over coefficients in increasing order of powers
+template <std::floating_point T, size_t Count>
+constexpr T horner(const std::array<double, Count>& c, T x) {
+    T p = T(c[Count - 1]);
+    for (size_t i = Count - 1; i > 0; --i) {
+        p = T(c[i - 1]) + p * x;
+    }
+    return p;
+}
+
+constexpr double power(double x, int n) {
+    double r = 1;
+    for (int i = 0; i < n; ++i) {
+        r *= x;
+    }
+    return r;
+}
+
+// 1 / (2 i + 1)
+template <int Count>
+constexpr std::array<double, Count> kAtanhCoefficients = [] {
+    std::array<double, Count> c{};
+    for (int i = 0; i < Count; ++i) {
+        c[i] = 1.0 / (2 * i + 1);
+    }
+    return c;
+}();
+
+} // namespace detail
+
+/**
+ * exp(x) with relative error below
+ *   2 * (ln(2)/2)^(Degree+1) / (Degree+1)!
+ * for results in the normal range; arguments beyond it saturate to
+ * infinity or to a tiny normal number.
+ */
+template <int Degree, std::floating_point T>
+constexpr T exp(T x) {
+    using L = detail::FloatLayout<T>;
+    using Bits = typename L::Bits;
+    constexpr T ln2 = T(L::kLn2Hi) + T(L::kLn2Lo);
+    x = std::min(std::max(x, -T(L::kBias - 2) * ln2), T(L::kBias + 2) * ln2);
+
+    const T shifted = x * T(detail::kLog2E) + detail::kRoundShifter<T>;
+    const T k = shifted - detail::kRoundShifter<T>;
+    const T r = (x - k * T(L::kLn2Hi)) - k * T(L::kLn2Lo);
+
+    // 2^k is applied as 2^(k-1) * 2: results right below the overflow stay finite
+    return detail::horner(detail::kTaylorCoefficients<0, 1, Degree + 1, false>, r) *
+           detail::pow2_from_shifted<T>(std::bit_cast<Bits>(shifted) - 1) * T(2);
+}
+
+/**
+ * log(x) with relative error below
+ *   s^(2 Terms) / ((2 Terms + 1) (1 - s^2)),  s = 3 - 2 sqrt(2)
+ * log(0) is -inf, log of negative numbers and NaN is NaN.
+ */
+template <int Terms, std::floating_point T>
+constexpr T log(T x) {
+    using L = detail::FloatLayout<T>;
+    using Bits = typename L::Bits;
+    using Limits = std::numeric_limits<T>;
+    constexpr Bits mantissa_mask = (Bits(1) << L::kMantissa) - 1;
+    constexpr Bits exponent_mask = Bits(2 * L::kBias + 1);
+    constexpr T denormal_scale = T(uint64_t(1) << L::kMantissa);
+
+    // bring subnormal numbers into the normal range first
+    const bool subnormal = x < Limits::min();
+    const T y = subnormal ? x * denormal_scale : x;
+    const Bits bits = std::bit_cast<Bits>(y);
+
+    // y = m * 2^e, m in [sqrt(1/2), sqrt(2))
+    T e = detail::small_to_float<T>((bits >> L::kMantissa) & exponent_mask) -
+          T(L::kBias) - (subnormal ? T(L::kMantissa) : T(0));
+    T m = std::bit_cast<T>((bits & mantissa_mask) | (Bits(L::kBias) << L::kMantissa));
+    const bool upper = m > T(detail::kSqrt2);
+    m = upper ? m * T(0.5) : m;
+    e = upper ? e + T(1) : e;
+
+    // log(m) = 2 atanh(s) = 2 (s + s^3/3 + s^5/5 + ...)
+    const T s = (m - T(1)) / (m + T(1));
+    const T s2 = s * s;
+    const T p = detail::horner(detail::kAtanhCoefficients<Terms>, s2);
+    const T r = e * T(L::kLn2Hi) + (T(2) * s * p + e * T(L::kLn2Lo));
+
+    const T special = x == T(0) ? -Limits::infinity() : Limits::quiet_NaN();
+    const T finite = x > T(0) ? r : special;
+    return x == Limits::infinity() ? x : finite;
+}
+
+namespace detail {
+
+// sin and cos of the reduced argument r = x - k pi/2, |r| <= pi/4
+template <std::floating_point T>
+struct Quadrant {
+    T sin;
+    T cos;
+    typename FloatLayout<T>::Bits k;
+};
+
+template <int SinDegree, int CosDegree, std::floating_point T>
+constexpr Quadrant<T> reduce_quadrant(T x) {
+    using L = FloatLayout<T>;
+    using Bits = typename L::Bits;
+    static_assert(SinDegree % 2 == 1 && CosDegree % 2 == 0);
+
+    const T shifted = x * T(kTwoOverPi) + kRoundShifter<T>;
+    const T k = shifted - kRoundShifter<T>;
+    const T r = ((x - k * T(L::kPio2[0])) - k * T(L::kPio2[1])) - k * T(L::kPio2[2]);
+    const T r2 = r * r;
+
+    const T s = horner(kTaylorCoefficients<1, 2, SinDegree / 2 + 1, true>, r2);
+    const T c = horner(kTaylorCoefficients<0, 2, CosDegree / 2 + 1, true>, r2);
+    return { s * r, c, std::bit_cast<Bits>(shifted) };
+}
+
+template <std::floating_point T>
+constexpr T select_quadrant(T s, T c, typename FloatLayout<T>::Bits quadrant) {
+    const T v = (quadrant & 1) ? c : s;
+    return (quadrant & 2) ? -v : v;
+}
+
+} // namespace detail
+
+/**
+ * sin(x) with absolute error below
+ *   (pi/4)^(SinDegree+2) / (SinDegree+2)!  +  (pi/4)^(CosDegree+2) / (CosDegree+2)!
+ * for |x| <= 1e6 (1e3 for float); the argument reduction loses
+ * accuracy further away.
+ */
+template <int SinDegree, int CosDegree, std::floating_point T>
+constexpr T sin(T x) {
+    const auto q = detail::reduce_quadrant<SinDegree, CosDegree>(x);
+    return detail::select_quadrant(q.sin, q.cos, q.k);
+}
+
+/**
+ * cos(x), same bounds as sin
+ */
+template <int SinDegree, int CosDegree, std::floating_point T>
+constexpr T cos(T x) {
+    const auto q = detail::reduce_quadrant<SinDegree, CosDegree>(x);
+    return detail::select_quadrant(q.sin, q.cos, q.k + 1);
+}
+
+//------------------------------------------------------
+// error bounds of the kernels above and degrees selection
+
+constexpr double exp_error_bound(int degree) {
+    return 2 * detail::power(0.34657359027997264, degree + 1) *
+           detail::inverse_factorial(degree + 1);
+}
+
+constexpr double log_error_bound(int terms) {
+    constexpr double s = 0.17157287525381, s2 = s * s;
+    return detail::power(s2, terms) / ((2 * terms + 1) * (1 - s2));
+}
+
+constexpr double sin_error_bound(int degree) {
+    return detail::power(0.78539816339744831, degree + 2) *
+           detail::inverse_factorial(degree + 2);
+}
+
+constexpr double cos_error_bound(int degree) {
+    return sin_error_bound(degree);
+}
+
+namespace detail {
+
+template <class Bound>
+constexpr int min_degree(double tolerance, int first, int step, Bound bound) {
+    constexpr int kMaxDegree = 31;
+    int degree = first;
+    while (degree + step <= kMaxDegree && bound(degree) > tolerance) {
+        degree += step;
+    }
+    return degree;
+}
+
+} // namespace detail
+
+constexpr int exp_degree(double tolerance) {
+    return detail::min_degree(tolerance, 1, 1, exp_error_bound);
+}
+
+constexpr int log_terms(double tolerance) {
+    return detail::min_degree(tolerance, 1, 1, log_error_bound);
+}
+
+// sin and cos polynomials are evaluated together, each gets half of the tolerance
+constexpr int sin_degree(double tolerance) {
+    return detail::min_degree(tolerance / 2, 1, 2, sin_error_bound);
+}
+
+constexpr int cos_degree(double tolerance) {
+    return detail::min_degree(tolerance / 2, 0, 2, cos_error_bound);
+}
+
+} // namespace veritacpp::dsl::math::fast
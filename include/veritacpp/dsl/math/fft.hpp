@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/aligned_allocator.hpp>
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Discrete Fourier transforms and spectra of expressions.
+ *
+ * FftPlan(n) factors n into radices 4, 2, 3, 5, 7, ... and tabulates
+ * the twiddle factors once. Transforms of size n then run mixed radix
+ * Cooley-Tukey, decimation in time, with dedicated butterflies for
+ * radices 2 and 4 and a generic one for the others: a prime factor p
+ * costs n * p per stage, so sizes with large prime factors are slow.
+ * fft_plan(n) returns a plan from a process wide cache, and fft() and
+ * inverse_fft() use it, so transforms of one size share their tables.
+ *
+ * spectrum(f, t, sample_rate, n, coeffs...) samples f, real or complex,
+ * at t_k = k / sample_rate for k < n, the other variables set to the
+ * coefficients, and returns its transform
+ *   X_j = sum over k of f(t_k) exp(-2 pi i j k / n)
+ * Bin j is the frequency j * sample_rate / n; for real f the bins past
+ * n / 2 mirror the negative frequencies.
+ * Samples go to a cache line aligned buffer of the calling thread,
+ * reused from frame to frame; the overload taking a span of bins
+ * transforms straight into the caller's storage, so frames of a known
+ * size allocate nothing.
+ */
+namespace veritacpp::dsl::math {
+
+class FftPlan {
+public:
+    using Value = std::complex<double>;
+
+    explicit FftPlan(size_t n) : n_{ n } {
+        // radix 4 stages first: they do the most work per pass
+        size_t rest = n;
+        for (size_t p = 4; rest > 1;) {
+            while (rest % p) {
+                p = p == 4 ? 2 : p == 2 ? 3 : p + 2;
+                if (p * p > rest) {
+                    p = rest;
+                }
+            }
+            rest /= p;
+            factors_.push_back(p);
+            factors_.push_back(rest);
+            max_radix_ = std::max(max_radix_, p);
+        }
+
+        forward_twiddles_.resize(n);
+        inverse_twiddles_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const double phase = -2 * std::numbers::pi * double(i) / double(n);
+            forward_twiddles_[i] = std::polar(1.0, phase);
+            inverse_twiddles_[i] = std::conj(forward_twiddles_[i]);
+        }
+    }
+
+    size_t size() const {
+        return n_;
+    }
+
+    // out = DFT(in); in and out hold size() values and should not overlap
+    void forward(std::span<const Value> in, std::span<Value> out) const {
+        transform(in, out, false);
+    }
+
+    // out = inverse DFT(in), scaled by 1 / size(): inverse of forward
+    void inverse(std::span<const Value> in, std::span<Value> out) const {
+        transform(in, out, true);
+        for (auto& v : out.first(n_)) {
+            v /= double(n_);
+        }
+    }
+
+private:
+    void transform(std::span<const Value> in, std::span<Value> out, bool inverse) const {
+        assert(in.size() >= n_ && out.size() >= n_);
+        if (n_ == 0) {
+            return;
+        }
+        if (n_ == 1) {
+            out[0] = in[0];
+            return;
+        }
+        // reused by the transforms of a thread
+        thread_local std::vector<Value> scratch;
+        scratch.resize(std::max(scratch.size(), max_radix_));
+        const Pass pass{ inverse ? inverse_twiddles_.data() : forward_twiddles_.data(),
+                         scratch.data(), inverse };
+        work(pass, out.data(), in.data(), 1, factors_.data());
+    }
+
+    struct Pass {
+        const Value* twiddles;
+        Value* scratch;
+        bool inverse;
+    };
+
+    // transform of the p * m values in[0], in[stride], ...
+    void work(const Pass& pass, Value* out, const Value* in, size_t stride,
+              const size_t* factors) const {
+        const size_t p = factors[0];
+        const size_t m = factors[1];
+        if (m == 1) {
+            for (size_t k = 0; k < p; ++k) {
+                out[k] = in[k * stride];
+            }
+        } else {
+            // p interleaved transforms of length m
+            for (size_t q = 0; q < p; ++q) {
+                work(pass, out + q * m, in + q * stride, stride * p, factors + 2);
+            }
+        }
+        switch (p) {
+        case 2:
+            butterfly2(pass, out, stride, m);
+            break;
+        case 4:
+            butterfly4(pass, out, stride, m);
+            break;
+        default:
+            butterfly(pass, out, stride, m, p);
+            break;
+        }
+    }
+
+    static void butterfly2(const Pass& pass, Value* out, size_t stride, size_t m) {
+        for (size_t k = 0; k < m; ++k) {
+            const Value t = out[k + m] * pass.twiddles[k * stride];
+            out[k + m] = out[k] - t;
+            out[k] += t;
+        }
+    }
+
+    static void butterfly4(const Pass& pass, Value* out, size_t stride, size_t m) {
+        const auto* tw = pass.twiddles;
+        for (size_t k = 0; k < m; ++k) {
+            const Value s0 = out[k + m] * tw[k * stride];
+            const Value s1 = out[k + 2 * m] * tw[2 * k * stride];
+            const Value s2 = out[k + 3 * m] * tw[3 * k * stride];
+            const Value s5 = out[k] - s1;
+            const Value s6 = out[k] + s1;
+            const Value s3 = s0 + s2;
+            const Value s4 = s0 - s2;
+            // s4 times -i forwards, +i inverse
+            const Value s4i = pass.inverse ? Value{ -s4.imag(), s4.real() }
+                                           : Value{ s4.imag(), -s4.real() };
+            out[k] = s6 + s3;
+            out[k + 2 * m] = s6 - s3;
+            out[k + m] = s5 + s4i;
+            out[k + 3 * m] = s5 - s4i;
+        }
+    }
+
+    void butterfly(const Pass& pass, Value* out, size_t stride, size_t m, size_t p) const {
+        auto* const scratch = pass.scratch;
+        for (size_t u = 0; u < m; ++u) {
+            for (size_t q = 0; q < p; ++q) {
+                scratch[q] = out[u + q * m];
+            }
+            for (size_t q1 = 0; q1 < p; ++q1) {
+                const size_t k = u + q1 * m;
+                Value sum = scratch[0];
+                size_t index = 0;
+                for (size_t q = 1; q < p; ++q) {
+                    index += stride * k;
+                    if (index >= n_) {
+                        index -= n_;
+                    }
+                    sum += scratch[q] * pass.twiddles[index];
+                }
+                out[k] = sum;
+            }
+        }
+    }
+
+    size_t n_;
+    size_t max_radix_ = 0;
+    std::vector<size_t> factors_; // pairs of radix, length left after it
+    std::vector<Value> forward_twiddles_;
+    std::vector<Value> inverse_twiddles_;
+};
+
+/**
+ * Plan for size n, made on first use and kept for the life of
+ * the process. Plans are immutable and shared between threads.
+ */
+inline const FftPlan& fft_plan(size_t n) {
+    static std::mutex mutex;
+    static std::map<size_t, std::unique_ptr<const FftPlan>> plans;
+    std::lock_guard lock{ mutex };
+    auto& plan = plans[n];
+    if (!plan) {
+        plan = std::make_unique<const FftPlan>(n);
+    }
+    return *plan;
+}
+
+inline std::vector<std::complex<double>> fft(std::span<const std::complex<double>> x) {
+    std::vector<std::complex<double>> out(x.size());
+    fft_plan(x.size()).forward(x, out);
+    return out;
+}
+
+inline std::vector<std::complex<double>> inverse_fft(std::span<const std::complex<double>> x) {
+    std::vector<std::complex<double>> out(x.size());
+    fft_plan(x.size()).inverse(x, out);
+    return out;
+}
+
+struct Spectrum {
+    std::vector<std::complex<double>> bins;
+    double resolution = 0; // frequency step between bins
+
+    double frequency(size_t j) const {
+        return double(j) * resolution;
+    }
+};
+
+namespace detail {
+
+// samples of a block of the spectrum
+constexpr size_t kSpectrumBlock = 4096;
+
+// argument idx of f: the sampled variable I or a coefficient
+template <uint64_t idx, uint64_t I, class Coefficients>
+constexpr auto sample_argument(double t, const Coefficients& c) {
+    if constexpr (idx == I) {
+        return t;
+    } else {
+        return std::get<idx - (idx > I)>(c);
+    }
+}
+
+} // namespace detail
+
+/**
+ * Transform of bins.size() samples of f into bins, see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+void spectrum(const F& f, Variable<I>, double sample_rate, std::span<std::complex<double>> bins,
+              C... coefficients) {
+    assert(sample_rate > 0);
+    const size_t n = bins.size();
+    const auto c = std::make_tuple(coefficients...);
+
+    thread_local utils::AlignedVector<std::complex<double>> buffer;
+    auto& samples = buffer; // the caller's buffer, also on the workers
+    samples.resize(n);
+    const size_t blocks = (n + detail::kSpectrumBlock - 1) / detail::kSpectrumBlock;
+    utils::default_thread_pool().parallel_for(blocks, [&](size_t block) {
+        const size_t end = std::min(n, (block + 1) * detail::kSpectrumBlock);
+        [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            for (size_t k = block * detail::kSpectrumBlock; k < end; ++k) {
+                const double t = double(k) / sample_rate;
+                samples[k] = std::complex<double>(
+                    evaluate<Policy>(f, detail::sample_argument<idx, I>(t, c)...));
+            }
+        }(std::make_index_sequence<sizeof...(C) + 1>{});
+    }, 1);
+
+    fft_plan(n).forward(samples, bins);
+}
+
+/**
+ * Transform of n samples of f, see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Spectrum spectrum(const F& f, Variable<I> t, double sample_rate, size_t n, C... coefficients) {
+    assert(sample_rate > 0);
+    Spectrum s{ std::vector<std::complex<double>>(n), sample_rate / double(n) };
+    spectrum<Policy>(f, t, sample_rate, std::span(s.bins), coefficients...);
+    return s;
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <ranges>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/linalg.hpp>
+#include <veritacpp/dsl/math/optimize.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Nonlinear least squares fitting with Levenberg-Marquardt.
+ *
+ * fit(model, params, xs, ys) adjusts the parameters of model so that
+ * model(params..., xs[i]) approximates ys[i] in the least squares sense.
+ * The first P variables of the model are its parameters, P being the
+ * size of params, and variable P is the data:
+ *
+ *   // a exp(b t) + c
+ *   auto model = a * exp(b * t) + c;  // a, b, c, t = Variable<0..3>
+ *   auto result = fit(model, std::array{ 1.0, -1.0, 0.0 }, ts, ys);
+ *
+ * Parameter derivatives of the model are built by diff once per call.
+ * Residuals and Jacobian rows are evaluated in blocks of points, every
+ * row by a separate loop over the block that vectorizes with FastMath;
+ * blocks are spread over the thread pool and reduced straight into the
+ * normal equations, so the Jacobian is never stored whole.
+ */
+namespace veritacpp::dsl::math {
+
+enum class FitStatus : uint8_t {
+    Converged,
+    MaxIterations,
+    Singular, // the normal equations stayed singular for any damping
+    Stalled,  // no step decreased the sum of squares for any damping
+    NotFinite // the residuals or the Jacobian were not finite at params
+};
+
+struct FitOptions {
+    double tolerance = 1e-10;          // on the step, relative to |params|
+    double gradient_tolerance = 1e-14; // on max |J^T r|, relative to the sum of squares
+    uint32_t max_iterations = 200;
+    double initial_damping = 1e-3;
+};
+
+template <size_t P>
+struct FitResult {
+    std::array<double, P> params;
+    double residual_sum_of_squares;
+    uint32_t iterations;
+    FitStatus status;
+};
+
+namespace detail {
+
+// points of a block: Jacobian rows of a block stay in L1 for a few parameters
+constexpr size_t kFitBlock = 256;
+
+template <size_t P>
+struct NormalEquations {
+    linalg::Matrix<P> jtj{}; // lower triangle only
+    linalg::Vector<P> jtr{};
+    double rss = 0;
+
+    constexpr NormalEquations& operator += (const NormalEquations& other) {
+        for (size_t a = 0; a < P; ++a) {
+            for (size_t b = 0; b <= a; ++b) {
+                jtj[a][b] += other.jtj[a][b];
+            }
+            jtr[a] += other.jtr[a];
+        }
+        rss += other.rss;
+        return *this;
+    }
+};
+
+template <class Policy, size_t P, class Model, class Partials>
+class LeastSquares {
+public:
+    LeastSquares(const Model& model, const Partials& partials,
+                 const double* xs, const double* ys, size_t n)
+        : model_{model}, partials_{partials}, xs_{xs}, ys_{ys}, n_{n},
+          blocks_((n + kFitBlock - 1) / kFitBlock) {}
+
+    // residual sum of squares at params
+    double rss(const std::array<double, P>& params) {
+        return accumulate<false>(params).rss;
+    }
+
+    // normal equations of the linearization at params
+    NormalEquations<P> linearize(const std::array<double, P>& params) {
+        return accumulate<true>(params);
+    }
+
+private:
+    template <bool Jacobian>
+    NormalEquations<P> accumulate(const std::array<double, P>& params) {
+        utils::default_thread_pool().parallel_for(blocks_.size(), [&](size_t block) {
+            blocks_[block] = accumulate_block<Jacobian>(params, block);
+        }, 1);
+        // fixed order of the reduction: results do not depend on scheduling
+        NormalEquations<P> total;
+        for (const auto& block : blocks_) {
+            total += block;
+        }
+        return total;
+    }
+
+    template <bool Jacobian>
+    NormalEquations<P> accumulate_block(const std::array<double, P>& params, size_t block) const {
+        const size_t first = block * kFitBlock;
+        const size_t count = std::min(kFitBlock, n_ - first);
+        const double* const x = xs_ + first;
+        const double* const y = ys_ + first;
+
+        const auto evaluate_rows = [&](const auto& f, double* out) {
+            [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+                for (size_t i = 0; i < count; ++i) {
+                    out[i] = static_cast<double>(evaluate<Policy>(f, params[idx]..., x[i]));
+                }
+            }(std::make_index_sequence<P>{});
+        };
+
+        NormalEquations<P> result;
+        std::array<double, kFitBlock> r;
+        evaluate_rows(model_, r.data());
+        for (size_t i = 0; i < count; ++i) {
+            r[i] -= y[i];
+            result.rss += r[i] * r[i];
+        }
+        if constexpr (Jacobian) {
+            std::array<std::array<double, kFitBlock>, P> j;
+            [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+                (evaluate_rows(std::get<idx>(partials_), j[idx].data()), ...);
+            }(std::make_index_sequence<P>{});
+            for (size_t a = 0; a < P; ++a) {
+                for (size_t b = 0; b <= a; ++b) {
+                    double s = 0;
+                    for (size_t i = 0; i < count; ++i) {
+                        s += j[a][i] * j[b][i];
+                    }
+                    result.jtj[a][b] = s;
+                }
+                double s = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    s += j[a][i] * r[i];
+                }
+                result.jtr[a] = s;
+            }
+        }
+        return result;
+    }
+
+    const Model& model_;
+    const Partials& partials_;
+    const double* xs_;
+    const double* ys_;
+    size_t n_;
+    std::vector<NormalEquations<P>> blocks_;
+};
+
+} // namespace detail
+
+
+/**
+ * Least squares fit of the model to points (xs[i], ys[i]) starting
+ * from params, see the top of the file. xs and ys are contiguous ranges
+ * of double of the same size.
+ * Policy selects evaluation kernels (evaluate.hpp).
+ */
+template <class Policy = Precise, Functional Model, size_t P,
+          std::ranges::contiguous_range Xs, std::ranges::contiguous_range Ys>
+requires NVariablesFunctional<P + 1, Model>
+FitResult<P> fit(const Model& model, const std::array<double, P>& params,
+                 const Xs& xs, const Ys& ys, const FitOptions& options = {}) {
+    const auto n = std::ranges::size(xs);
+    assert(std::ranges::size(ys) == n);
+
+    const auto partials = gradient<P>(model);
+    detail::LeastSquares<Policy, P, Model, decltype(partials)> problem{
+        model, partials, std::ranges::data(xs), std::ranges::data(ys), n
+    };
+
+    auto p = params;
+    auto normal = problem.linearize(p);
+    double damping = options.initial_damping;
+    for (uint32_t iteration = 0; iteration < options.max_iterations; ++iteration) {
+        double gradient_norm = 0;
+        bool finite = std::isfinite(normal.rss);
+        for (size_t a = 0; a < P; ++a) {
+            gradient_norm = std::max(gradient_norm, std::abs(normal.jtr[a]));
+            finite = finite && std::isfinite(normal.jtr[a]);
+        }
+        if (!finite) {
+            return { p, normal.rss, iteration, FitStatus::NotFinite };
+        }
+        if (gradient_norm <= options.gradient_tolerance * std::max(1.0, normal.rss)) {
+            return { p, normal.rss, iteration, FitStatus::Converged };
+        }
+
+        // (J^T J + damping diag(J^T J)) step = -J^T r, more damping until the step pays off
+        while (true) {
+            auto a = normal.jtj;
+            linalg::Vector<P> step;
+            for (size_t i = 0; i < P; ++i) {
+                // a floor keeps parameters the model does not depend on solvable
+                a[i][i] += damping * std::max(normal.jtj[i][i], 1e-300);
+                step[i] = -normal.jtr[i];
+            }
+            const bool solved = linalg::cholesky_solve(a, step);
+
+            std::array<double, P> trial;
+            double step_norm = 0, params_norm = 0;
+            for (size_t i = 0; i < P; ++i) {
+                trial[i] = p[i] + step[i];
+                step_norm += step[i] * step[i];
+                params_norm += p[i] * p[i];
+            }
+            const bool small = step_norm <= options.tolerance * options.tolerance *
+                                            std::max(1.0, params_norm);
+            const double rss = solved ? problem.rss(trial) : normal.rss;
+            // a small step into points where the model is not finite has not converged
+            if (solved && small && std::isfinite(rss)) {
+                return { p, normal.rss, iteration + 1, FitStatus::Converged };
+            }
+            if (solved && rss < normal.rss) {
+                damping = std::max(damping / 10, 1e-12);
+                p = trial;
+                normal = problem.linearize(p);
+                break;
+            }
+            damping *= 10;
+            if (damping > 1e16) {
+                const auto status = solved ? FitStatus::Stalled : FitStatus::Singular;
+                return { p, normal.rss, iteration + 1, status };
+            }
+        }
+    }
+    return { p, normal.rss, options.max_iterations, FitStatus::MaxIterations };
+}
+
+} // veritacpp::dsl::math
@@ -1,24 +1,34 @@
 #pragma once
 
 #include <array>
+#include <functional>
+#include <tuple>
+#include <type_traits>
 
 #include <veritacpp/dsl/math/core_concepts.hpp>
 #include <veritacpp/dsl/math/variable.hpp>
 #include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/constexpr_math.hpp>
+#include <veritacpp/dsl/math/storage.hpp>
 
 #include <veritacpp/utils/tuple.hpp>
 
 namespace veritacpp::dsl::math { 
 
 template <Functional F>
-struct Negate : BasicFunction {
-    F f;
-    explicit constexpr Negate(F f) : f(f) {}
-
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const 
-    requires NVariablesFunctional<sizeof...(x), F>
-    {
-        return -(f(x...));
+struct Negate : FunctionNode<Negate<F>> {
+    [[no_unique_address]] detail::NodePack<Negate, F> args;
+    static constexpr uint64_t arity = detail::max_arity<F>;
+
+    constexpr Negate() = default;
+    explicit constexpr Negate(F f) : args{f} {}
+
+    constexpr decltype(auto) f() const { return args.template get<0>(); }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return -(f()(x...));
     } 
 };
 
@@ -33,34 +43,197 @@ constexpr Functional auto operator + (F f) {
 }
 
 template<Functional F1, Functional F2>
-struct Add : BasicFunction {
-    F1 f1;
-    F2 f2;
-    explicit constexpr Add(F1 f1, F2 f2) : f1{f1}, f2{f2} {};
+struct Add : FunctionNode<Add<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Add, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
 
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const 
-    requires NVariablesFunctional<sizeof...(x), F1> 
-          && NVariablesFunctional<sizeof...(x), F2> {
-        return f1(x...) + f2(x...);
+    constexpr Add() = default;
+    explicit constexpr Add(F1 f1, F2 f2) : args{f1, f2} {}
+
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return f1()(x...) + f2()(x...);
     }
 };
 
+
+namespace detail {
+
+/**
+ * Tree-shaped reduction of values: independent halves do not wait
+ * for each other, unlike a left fold, and rounding errors grow as
+ * log(N). Values are reduced in place, stride by stride.
+ */
+template <class T, size_t N, class Op>
+constexpr T pairwise_reduce(std::array<T, N> values, Op op) {
+    for (size_t stride = 1; stride < N; stride *= 2) {
+        for (size_t i = 0; i + stride < N; i += 2 * stride) {
+            values[i] = op(values[i], values[i + stride]);
+        }
+    }
+    return values[0];
+}
+
+// (group, position in group) of every element of concatenated groups
+template <class Groups>
+constexpr auto kFlatIndex = []<uint64_t... g>(std::integer_sequence<uint64_t, g...>) {
+    constexpr std::array<uint64_t, sizeof...(g)> sizes = {
+        std::tuple_size_v<std::tuple_element_t<g, Groups>>...
+    };
+    std::array<std::pair<uint64_t, uint64_t>, (sizes[g] + ... + 0)> index{};
+    uint64_t k = 0;
+    for (uint64_t group = 0; group < sizes.size(); ++group) {
+        for (uint64_t i = 0; i < sizes[group]; ++i) {
+            index[k++] = { group, i };
+        }
+    }
+    return index;
+}(std::make_integer_sequence<uint64_t, std::tuple_size_v<Groups>>{});
+
+/**
+ * Nary node of all elements of tuple of tuples, without
+ * materializing their concatenation: Unit if there are none,
+ * the element itself if there is only one
+ */
+template <template <class...> class Nary, Functional Unit, class Groups>
+constexpr Functional auto flatten_groups(const Groups& groups) {
+    constexpr auto& index = kFlatIndex<Groups>;
+    if constexpr (index.size() == 0) {
+        return Unit{};
+    } else if constexpr (index.size() == 1) {
+        return std::get<index[0].second>(std::get<index[0].first>(groups));
+    } else {
+        return [&groups]<uint64_t... k>(std::integer_sequence<uint64_t, k...>) {
+            return Nary<std::tuple_element_t<index[k].second,
+                            std::tuple_element_t<index[k].first, Groups>>...> {
+                std::get<index[k].second>(std::get<index[k].first>(groups))...
+            };
+        }(std::make_integer_sequence<uint64_t, index.size()>{});
+    }
+}
+
+} // detail
+
+template<Functional... Fs>
+struct Sum : FunctionNode<Sum<Fs...>> {
+    static_assert(sizeof...(Fs) > 0);
+
+    [[no_unique_address]] detail::NodePack<Sum, Fs...> args;
+    static constexpr uint64_t arity = detail::max_arity<Fs...>;
+
+    constexpr Sum() = default;
+    explicit constexpr Sum(Fs... fs) : args{fs...} {}
+
+    template <uint64_t I>
+    constexpr decltype(auto) term() const { return args.template get<I>(); }
+
+    constexpr std::tuple<Fs...> terms() const {
+        return [this]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return std::tuple<Fs...>{ term<idx>()... };
+        }(std::make_index_sequence<sizeof...(Fs)>{});
+    }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            using R = std::common_type_t<decltype(term<idx>()(x...))...>;
+            return detail::pairwise_reduce(std::array<R, sizeof...(Fs)>{
+                static_cast<R>(term<idx>()(x...))... }, std::plus<>{});
+        }(std::make_index_sequence<sizeof...(Fs)>{});
+    }
+};
+
+namespace detail {
+
+template <class T>
+struct IsSumLike : std::false_type {};
+
+template <Functional F1, Functional F2>
+struct IsSumLike<Add<F1, F2>> : std::true_type {};
+
+template <Functional... Fs>
+struct IsSumLike<Sum<Fs...>> : std::true_type {};
+
+// operands of a sum, flattened one level
+template <Functional F>
+constexpr auto sum_terms(const F& f) {
+    return std::make_tuple(f);
+}
+
+template <Functional F1, Functional F2>
+constexpr auto sum_terms(const Add<F1, F2>& f) {
+    return std::make_tuple(f.f1(), f.f2());
+}
+
+template <Functional... Fs>
+constexpr auto sum_terms(const Sum<Fs...>& f) {
+    return f.terms();
+}
+
+template <Arithmetic auto C>
+requires (C == 0)
+constexpr auto sum_terms(Constant<C>) {
+    return std::tuple<>{};
+}
+
+} // detail
+
+/**
+ * Flat Sum of all arguments: nested Sum and Add are expanded,
+ * Constant<0> terms are dropped
+ */
+template <Functional... Fs>
+constexpr Functional auto sum_of(const Fs&... fs) {
+    constexpr bool flat = ((std::tuple_size_v<decltype(detail::sum_terms(fs))> == 1 &&
+                            !detail::IsSumLike<Fs>::value) && ...);
+    if constexpr (flat && sizeof...(Fs) > 1) {
+        return Sum<Fs...> { fs... };
+    } else {
+        return detail::flatten_groups<Sum, Constant<0>>(std::make_tuple(detail::sum_terms(fs)...));
+    }
+}
+
+/**
+ * Sum of gen(std::integral_constant<uint64_t, i>{}) for i in [0, N)
+ */
+template <uint64_t N, class Gen>
+constexpr Functional auto sum(Gen gen) {
+    return [&gen]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return sum_of(gen(std::integral_constant<uint64_t, idx>{})...);
+    }(std::make_index_sequence<N>{});
+}
+
 constexpr Functional auto operator + (Functional auto a, 
                                       Functional auto b) {
-    return Add { a, b };
+    using A = decltype(a);
+    using B = decltype(b);
+    if constexpr (detail::IsSumLike<A>::value || detail::IsSumLike<B>::value) {
+        return sum_of(a, b);
+    } else {
+        return Add { a, b };
+    }
 }
 
 template<Functional F1, Functional F2>
-struct Sub : BasicFunction {
-    F1 f1;
-    F2 f2;
-    explicit constexpr Sub(F1 f1, F2 f2) : f1{f1}, f2{f2} {};
+struct Sub : FunctionNode<Sub<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Sub, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
+
+    constexpr Sub() = default;
+    explicit constexpr Sub(F1 f1, F2 f2) : args{f1, f2} {}
 
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const
-    requires NVariablesFunctional<sizeof...(x), F1> 
-          && NVariablesFunctional<sizeof...(x), F2>
-    {
-        return f1(x...) - f2(x...);
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return f1()(x...) - f2()(x...);
     }
 };
 
@@ -70,36 +243,167 @@ constexpr Functional auto operator - (Functional auto a,
 }
 
 template<Functional F1, Functional F2>
-struct Mul : BasicFunction {
-    F1 f1;
-    F2 f2;
+struct Mul : FunctionNode<Mul<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Mul, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
+
+    constexpr Mul() = default;
+    explicit constexpr Mul(F1 f1, F2 f2) : args{f1, f2} {}
+
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return f1()(x...) * f2()(x...);
+    }
+};
+
+
+
+template<Functional... Fs>
+struct Product : FunctionNode<Product<Fs...>> {
+    static_assert(sizeof...(Fs) > 0);
+
+    [[no_unique_address]] detail::NodePack<Product, Fs...> args;
+    static constexpr uint64_t arity = detail::max_arity<Fs...>;
 
-    constexpr Mul(F1 f1, F2 f2) : f1{f1}, f2{f2} {}
+    constexpr Product() = default;
+    explicit constexpr Product(Fs... fs) : args{fs...} {}
 
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const
-    requires NVariablesFunctional<sizeof...(x), F1> 
-          && NVariablesFunctional<sizeof...(x), F2>
-    {
-        return f1(x...) * f2(x...);
+    template <uint64_t I>
+    constexpr decltype(auto) term() const { return args.template get<I>(); }
+
+    constexpr std::tuple<Fs...> terms() const {
+        return [this]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return std::tuple<Fs...>{ term<idx>()... };
+        }(std::make_index_sequence<sizeof...(Fs)>{});
+    }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            using R = std::common_type_t<decltype(term<idx>()(x...))...>;
+            return detail::pairwise_reduce(std::array<R, sizeof...(Fs)>{
+                static_cast<R>(term<idx>()(x...))... }, std::multiplies<>{});
+        }(std::make_index_sequence<sizeof...(Fs)>{});
     }
 };
 
+namespace detail {
+
+template <class T>
+struct IsZeroConstant : std::false_type {};
+
+template <Arithmetic auto C>
+requires (C == 0)
+struct IsZeroConstant<Constant<C>> : std::true_type {};
+
+template <class T>
+struct IsProductLike : std::false_type {};
+
+template <Functional F1, Functional F2>
+struct IsProductLike<Mul<F1, F2>> : std::true_type {};
+
+template <Functional... Fs>
+struct IsProductLike<Product<Fs...>> : std::true_type {};
+
+// operands of a product, flattened one level
+template <Functional F>
+constexpr auto product_terms(const F& f) {
+    return std::make_tuple(f);
+}
+
+template <Functional F1, Functional F2>
+constexpr auto product_terms(const Mul<F1, F2>& f) {
+    return std::make_tuple(f.f1(), f.f2());
+}
+
+template <Functional... Fs>
+constexpr auto product_terms(const Product<Fs...>& f) {
+    return f.terms();
+}
+
+template <Arithmetic auto C>
+requires (C == 1)
+constexpr auto product_terms(Constant<C>) {
+    return std::tuple<>{};
+}
+
+} // detail
+
+/**
+ * Flat Product of all arguments: nested Product and Mul are expanded,
+ * Constant<1> terms are dropped
+ */
+template <Functional... Fs>
+constexpr Functional auto product_of(const Fs&... fs) {
+    if constexpr ((detail::IsZeroConstant<Fs>::value || ...)) {
+        return kZero;
+    } else {
+        constexpr bool flat = ((std::tuple_size_v<decltype(detail::product_terms(fs))> == 1 &&
+                                !detail::IsProductLike<Fs>::value) && ...);
+        if constexpr (flat && sizeof...(Fs) > 1) {
+            return Product<Fs...> { fs... };
+        } else {
+            return detail::flatten_groups<Product, Constant<1>>(
+                std::make_tuple(detail::product_terms(fs)...));
+        }
+    }
+}
+
+/**
+ * Product of gen(std::integral_constant<uint64_t, i>{}) for i in [0, N)
+ */
+template <uint64_t N, class Gen>
+constexpr Functional auto product(Gen gen) {
+    return [&gen]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return product_of(gen(std::integral_constant<uint64_t, idx>{})...);
+    }(std::make_index_sequence<N>{});
+}
 
 constexpr Functional auto operator * (Functional auto f1, 
                                       Functional auto f2) {
-    return Mul { f1, f2 };
+    using F1 = decltype(f1);
+    using F2 = decltype(f2);
+    if constexpr (detail::IsProductLike<F1>::value || detail::IsProductLike<F2>::value) {
+        return product_of(f1, f2);
+    } else {
+        return Mul { f1, f2 };
+    }
+}
+
+namespace detail {
+
+// real divisors are promoted to double: no integer division
+template <Arithmetic T>
+constexpr auto divisor(T v) {
+    if constexpr (Complex<T>) {
+        return v;
+    } else {
+        return static_cast<double>(v);
+    }
 }
 
+} // namespace detail
+
 template <Functional F1, Functional F2>
-struct Div : BasicFunction {
-    F1 f1;
-    F2 f2;
-    constexpr Div(F1 f1, F2 f2) : f1{f1}, f2{f2} {}
+struct Div : FunctionNode<Div<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Div, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
+
+    constexpr Div() = default;
+    explicit constexpr Div(F1 f1, F2 f2) : args{f1, f2} {}
 
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const
-    requires NVariablesFunctional<sizeof...(x), F1> 
-          && NVariablesFunctional<sizeof...(x), F2> {
-        return f1(x...) / static_cast<double>(f2(x...));
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        return f1()(x...) / detail::divisor(f2()(x...));
     }
 };
 
@@ -109,24 +413,40 @@ constexpr Functional auto operator / (Functional auto f1,
 }
 
 template <Functional F, Functional... Gs>
-struct App : BasicFunction {
-    F f;
-    std::tuple<Gs...> gs;
-    constexpr explicit App(F f, Gs... gs) : f(f), gs{gs...} {}
-    constexpr explicit App(F f, std::tuple<Gs...> gs) : f(f), gs{gs} {}
-    
-
-    constexpr Arithmetic auto operator()(Arithmetic auto... x) const 
-    requires NVariablesFunctional<std::max(sizeof...(Gs), sizeof...(x)), F> 
-             && (NVariablesFunctional<sizeof...(x), Gs> && ...)
-    {
-        auto args = std::make_tuple(x...);
-        auto leftmost_args =  std::apply([&args](auto... g){
-            return std::make_tuple(apply(g, args)...);
-        }, gs);
-        auto [ignore, rightmost_args] = veritacpp::utils::split<sizeof...(Gs)>(args);
-        return std::apply(f, std::tuple_cat(leftmost_args, rightmost_args));
-    }  
+struct App : FunctionNode<App<F, Gs...>> {
+    // f is stored first, followed by gs
+    [[no_unique_address]] detail::NodePack<App, F, Gs...> args;
+    // variables of f past the gs are passed through
+    static constexpr uint64_t arity = std::max(detail::max_arity<Gs...>,
+        arity_v<F> > sizeof...(Gs) ? arity_v<F> : 0);
+
+    constexpr App() = default;
+    constexpr explicit App(F f, Gs... gs) : args{f, gs...} {}
+    constexpr explicit App(F f, std::tuple<Gs...> gs) 
+        : App(std::apply([f](Gs... g) { return App{f, g...}; }, gs)) {}
+
+    constexpr decltype(auto) f() const { return args.template get<0>(); }
+
+    template <uint64_t I>
+    constexpr decltype(auto) g() const { return args.template get<I + 1>(); }
+
+    constexpr std::tuple<Gs...> gs() const {
+        return [this]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return std::tuple<Gs...>{ g<idx>()... };
+        }(std::make_index_sequence<sizeof...(Gs)>{});
+    }
+
+    template <Arithmetic... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        // views of the arguments: nothing is copied, and the values of
+        // the gs live until f returns, at the end of the full expression
+        const auto xs = utils::forward_as_view(x...);
+        return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            return utils::apply(f(), utils::concat(utils::forward_as_view(g<idx>()(x...)...),
+                                                   utils::split<sizeof...(Gs)>(xs).second));
+        }(std::make_index_sequence<sizeof...(Gs)>{});
+    }
 };
 
 namespace detail {
@@ -220,10 +540,12 @@ constexpr Functional auto operator | (F f, VariableBindingGroup<Vars... > group)
 
 
 template <Arithmetic auto C>
-struct Pow : BasicFunction {
+struct Pow : FunctionNode<Pow<C>> {
+    static constexpr uint64_t arity = 1;
+
     constexpr Arithmetic auto operator()(Arithmetic auto x, 
                                          Arithmetic auto...) const {
-       return std::pow(x, C);
+       return constexpr_math::pow(x, C);
     }
 };
 
@@ -234,14 +556,15 @@ constexpr Functional auto operator ^ (Functional auto f, Constant<C>) {
 
 
 template <Arithmetic T>
-struct RTPow : BasicFunction {
+struct RTPow : FunctionNode<RTPow<T>> {
+    static constexpr uint64_t arity = 1;
 
     const RTConstant<T> deg;
     explicit constexpr RTPow(RTConstant<T> deg) : deg { deg } {}
 
     constexpr Arithmetic auto operator()(Arithmetic auto x, 
                                          Arithmetic auto...) const {
-       return std::pow(x, deg());
+       return constexpr_math::pow(x, deg());
     }
 };
 
@@ -293,31 +616,39 @@ constexpr auto operator / (T c, F f) {
 }
 
 
-struct Sin : BasicFunction {
+struct Sin : FunctionNode<Sin> {
+    static constexpr uint64_t arity = 1;
+
     template <Arithmetic X, Arithmetic... Args>
     constexpr Arithmetic auto operator()(X x, Args...) const {
-       return std::sin(x);
+       return constexpr_math::sin(x);
     }
 };
 
-struct Cos : BasicFunction {
+struct Cos : FunctionNode<Cos> {
+    static constexpr uint64_t arity = 1;
+
     template <Arithmetic X, Arithmetic... Args>
     constexpr Arithmetic auto operator()(X x, Args...) const {
-       return std::cos(x);
+       return constexpr_math::cos(x);
     }
 };
 
-struct Exp : BasicFunction {
+struct Exp : FunctionNode<Exp> {
+    static constexpr uint64_t arity = 1;
+
     template <Arithmetic X, Arithmetic... Args>
     constexpr Arithmetic auto operator()(X x, Args...) const {
-       return std::exp(x);
+       return constexpr_math::exp(x);
     }
 };
 
-struct Log : BasicFunction {
+struct Log : FunctionNode<Log> {
+    static constexpr uint64_t arity = 1;
+
     template <Arithmetic X, Arithmetic... Args>
     constexpr Arithmetic auto operator()(X x, Args...) const {
-       return std::log(x);
+       return constexpr_math::log(x);
     }
 };
 
@@ -394,4 +725,176 @@ constexpr Functional auto operator ^ (Functional auto f,
     return exp(log(f) * g);
 }
 
+
+//------------------------------------------------------
+// piecewise functions: all pieces are evaluated and the result
+// selected, so evaluation has no branches and vectorizes.
+// Apart from abs they need ordered, real values
+
+// modulus of complex numbers
+struct Abs : FunctionNode<Abs> {
+    static constexpr uint64_t arity = 1;
+
+    template <Arithmetic X, Arithmetic... Args>
+    constexpr Arithmetic auto operator()(X x, Args...) const {
+        if constexpr (Complex<X>) {
+            return std::abs(x);
+        } else {
+            return x < X(0) ? -x : x;
+        }
+    }
+};
+
+// -1, 0 or 1
+struct Sign : FunctionNode<Sign> {
+    static constexpr uint64_t arity = 1;
+
+    template <Real X, Arithmetic... Args>
+    constexpr Arithmetic auto operator()(X x, Args...) const {
+       return X((x > X(0)) - (x < X(0)));
+    }
+};
+
+constexpr Functional auto abs(Functional auto f) {
+    return Abs{} | f;
+}
+
+constexpr Functional auto sign(Functional auto f) {
+    return Sign{} | f;
+}
+
+template <Functional F1, Functional F2>
+struct Min : FunctionNode<Min<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Min, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
+
+    constexpr Min() = default;
+    explicit constexpr Min(F1 f1, F2 f2) : args{f1, f2} {}
+
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        const auto a = f1()(x...);
+        const auto b = f2()(x...);
+        return b < a ? b : a;
+    }
+};
+
+template <Functional F1, Functional F2>
+struct Max : FunctionNode<Max<F1, F2>> {
+    [[no_unique_address]] detail::NodePack<Max, F1, F2> args;
+    static constexpr uint64_t arity = detail::max_arity<F1, F2>;
+
+    constexpr Max() = default;
+    explicit constexpr Max(F1 f1, F2 f2) : args{f1, f2} {}
+
+    constexpr decltype(auto) f1() const { return args.template get<0>(); }
+    constexpr decltype(auto) f2() const { return args.template get<1>(); }
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        const auto a = f1()(x...);
+        const auto b = f2()(x...);
+        return a < b ? b : a;
+    }
+};
+
+// f limited to [lo, hi]
+template <Functional F, Functional Lo, Functional Hi>
+struct Clamp : FunctionNode<Clamp<F, Lo, Hi>> {
+    [[no_unique_address]] detail::NodePack<Clamp, F, Lo, Hi> args;
+    static constexpr uint64_t arity = detail::max_arity<F, Lo, Hi>;
+
+    constexpr Clamp() = default;
+    explicit constexpr Clamp(F f, Lo lo, Hi hi) : args{f, lo, hi} {}
+
+    constexpr decltype(auto) f() const { return args.template get<0>(); }
+    constexpr decltype(auto) lo() const { return args.template get<1>(); }
+    constexpr decltype(auto) hi() const { return args.template get<2>(); }
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        const auto v = f()(x...);
+        const auto l = lo()(x...);
+        const auto h = hi()(x...);
+        return v < l ? l : (h < v ? h : v);
+    }
+};
+
+// cond > 0 ? f : g
+template <Functional Cond, Functional F, Functional G>
+struct Select : FunctionNode<Select<Cond, F, G>> {
+    [[no_unique_address]] detail::NodePack<Select, Cond, F, G> args;
+    static constexpr uint64_t arity = detail::max_arity<Cond, F, G>;
+
+    constexpr Select() = default;
+    explicit constexpr Select(Cond cond, F f, G g) : args{cond, f, g} {}
+
+    constexpr decltype(auto) cond() const { return args.template get<0>(); }
+    constexpr decltype(auto) f() const { return args.template get<1>(); }
+    constexpr decltype(auto) g() const { return args.template get<2>(); }
+
+    template <Real... X>
+    requires (sizeof...(X) >= arity)
+    constexpr Arithmetic auto operator()(X... x) const {
+        const auto c = cond()(x...);
+        const auto a = f()(x...);
+        const auto b = g()(x...);
+        return c > 0 ? a : b;
+    }
+};
+
+namespace detail {
+
+template <Functional F>
+constexpr F as_functional(F f) {
+    return f;
+}
+
+template <Arithmetic T>
+constexpr RTConstant<T> as_functional(T c) {
+    return RTConstant { c };
+}
+
+// operands of the piecewise functions: at least one should be a Functional
+template <class... T>
+concept PiecewiseOperands = ((Functional<T> || Real<T>) && ...) &&
+                            (Functional<T> || ...);
+
+} // namespace detail
+
+template <class A, class B>
+requires detail::PiecewiseOperands<A, B>
+constexpr Functional auto min(A a, B b) {
+    return Min { detail::as_functional(a), detail::as_functional(b) };
+}
+
+template <class A, class B>
+requires detail::PiecewiseOperands<A, B>
+constexpr Functional auto max(A a, B b) {
+    return Max { detail::as_functional(a), detail::as_functional(b) };
+}
+
+template <Functional F, class Lo, class Hi>
+requires detail::PiecewiseOperands<F, Lo, Hi>
+constexpr Functional auto clamp(F f, Lo lo, Hi hi) {
+    return Clamp { f, detail::as_functional(lo), detail::as_functional(hi) };
+}
+
+template <Functional Cond, class F, class G>
+requires detail::PiecewiseOperands<Cond, F, G>
+constexpr Functional auto select(Cond cond, F f, G g) {
+    if constexpr (std::same_as<F, G> && StatelessFunctional<F>) {
+        // both pieces are the same function
+        return f;
+    } else {
+        return Select { cond, detail::as_functional(f), detail::as_functional(g) };
+    }
+}
+
 }
\ No newline at end of file
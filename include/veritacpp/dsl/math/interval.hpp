@@ -0,0 +1,658 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+#include <veritacpp/utils/tuple.hpp>
+
+/**
+ * Interval evaluation of Functionals.
+ *
+ * enclose(f, x...) evaluates f with every variable an Interval and
+ * returns an interval containing f(v...) for all points v of the box.
+ * Every node propagates the tightest enclosure of its own result
+ * (monotonicity of exp and log, extrema of sin, cos and even powers),
+ * rounded outwards, so enclosures hold despite floating point rounding.
+ * bound(f, box) is enclose over a Box.
+ *
+ * Enclosures let searches discard whole boxes:
+ *
+ * minimize_global<N>(f, box, options) finds the global minimum of f
+ * over a box by branch and bound. Lower bounds of a box are the better
+ * of the natural enclosure and the mean value form, with the gradient
+ * built by diff. Boxes are bisected along their widest side; a box whose
+ * lower bound exceeds the best value found so far is discarded. Each
+ * round processes the boxes with the lowest bounds on the thread pool.
+ *
+ * isolate_roots(f, domain, options) finds intervals that contain all
+ * zeros of a univariate f, flagging those proven to hold exactly one
+ * (the enclosure of f', built by diff, excludes 0 and f changes sign).
+ */
+namespace veritacpp::dsl::math {
+
+struct Interval {
+    double lo;
+    double hi;
+
+    constexpr Interval(double v = 0) : lo{v}, hi{v} {}
+    constexpr Interval(double lo, double hi) : lo{lo}, hi{hi} {}
+
+    constexpr double width() const { return hi - lo; }
+    constexpr double midpoint() const { return lo + 0.5 * (hi - lo); }
+    constexpr bool contains(double v) const { return lo <= v && v <= hi; }
+
+    // neither bound is NaN
+    constexpr bool valid() const { return lo <= hi; }
+
+    static constexpr Interval entire() {
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        return { -inf, inf };
+    }
+
+    constexpr bool operator == (const Interval&) const = default;
+};
+
+template <size_t N>
+using Box = std::array<Interval, N>;
+
+namespace detail {
+
+// one ulp outwards on each side: covers a correctly rounded operation
+inline Interval outward(double lo, double hi) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    return { std::nextafter(lo, -inf), std::nextafter(hi, inf) };
+}
+
+// libm transcendentals are within an ulp or two of the exact result
+inline Interval outward2(double lo, double hi) {
+    const auto once = outward(lo, hi);
+    return outward(once.lo, once.hi);
+}
+
+// 0 * inf is 0 for bounds: the 0 is exact, the infinity is not reached
+inline double bound_product(double a, double b) {
+    return (a == 0 || b == 0) ? 0 : a * b;
+}
+
+// p + 2 pi k lies in x for some integer k, also when it is on the edge
+inline bool contains_periodic(const Interval& x, double p) {
+    constexpr double period = 2 * std::numbers::pi;
+    constexpr double slack = 1e-12;
+    return std::floor((x.hi - p) / period + slack) >= std::ceil((x.lo - p) / period - slack);
+}
+
+inline Interval nan_interval() {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    return { nan, nan };
+}
+
+} // namespace detail
+
+inline Interval operator - (const Interval& x) {
+    return { -x.hi, -x.lo };
+}
+
+inline Interval operator + (const Interval& a, const Interval& b) {
+    return detail::outward(a.lo + b.lo, a.hi + b.hi);
+}
+
+inline Interval operator - (const Interval& a, const Interval& b) {
+    return detail::outward(a.lo - b.hi, a.hi - b.lo);
+}
+
+inline Interval operator * (const Interval& a, const Interval& b) {
+    const double p[] = {
+        detail::bound_product(a.lo, b.lo), detail::bound_product(a.lo, b.hi),
+        detail::bound_product(a.hi, b.lo), detail::bound_product(a.hi, b.hi)
+    };
+    return detail::outward(std::min({ p[0], p[1], p[2], p[3] }),
+                           std::max({ p[0], p[1], p[2], p[3] }));
+}
+
+inline Interval operator / (const Interval& a, const Interval& b) {
+    if (b.contains(0)) {
+        return Interval::entire();
+    }
+    return a * detail::outward(1 / b.hi, 1 / b.lo);
+}
+
+namespace interval {
+
+inline Interval pow(const Interval& x, int64_t n) {
+    if (n == 0) {
+        return 1;
+    }
+    if (n < 0) {
+        return Interval{ 1 } / pow(x, -n);
+    }
+    const double lo = std::pow(x.lo, double(n));
+    const double hi = std::pow(x.hi, double(n));
+    if (n % 2 == 1 || x.lo >= 0) {
+        return detail::outward2(lo, hi);
+    }
+    if (x.hi <= 0) {
+        return detail::outward2(hi, lo);
+    }
+    return { 0, detail::outward2(0, std::max(lo, hi)).hi };
+}
+
+inline Interval pow(const Interval& x, double c) {
+    if (c == std::trunc(c) && std::abs(c) < 0x1p62) {
+        return pow(x, int64_t(c));
+    }
+    // x^c = exp(c log x) is defined for x >= 0
+    if (x.hi < 0) {
+        return detail::nan_interval();
+    }
+    const double lo = std::pow(std::max(x.lo, 0.0), c);
+    const double hi = std::pow(x.hi, c);
+    const auto r = c > 0 ? detail::outward2(lo, hi) : detail::outward2(hi, lo);
+    return { std::max(r.lo, 0.0), r.hi };
+}
+
+inline Interval sin(const Interval& x) {
+    if (!(x.width() < 2 * std::numbers::pi)) {
+        return x.valid() ? Interval{ -1, 1 } : detail::nan_interval();
+    }
+    const double a = std::sin(x.lo);
+    const double b = std::sin(x.hi);
+    auto r = detail::outward2(std::min(a, b), std::max(a, b));
+    if (detail::contains_periodic(x, std::numbers::pi / 2)) {
+        r.hi = 1;
+    }
+    if (detail::contains_periodic(x, -std::numbers::pi / 2)) {
+        r.lo = -1;
+    }
+    return { std::max(r.lo, -1.0), std::min(r.hi, 1.0) };
+}
+
+inline Interval cos(const Interval& x) {
+    if (!(x.width() < 2 * std::numbers::pi)) {
+        return x.valid() ? Interval{ -1, 1 } : detail::nan_interval();
+    }
+    const double a = std::cos(x.lo);
+    const double b = std::cos(x.hi);
+    auto r = detail::outward2(std::min(a, b), std::max(a, b));
+    if (detail::contains_periodic(x, 0)) {
+        r.hi = 1;
+    }
+    if (detail::contains_periodic(x, std::numbers::pi)) {
+        r.lo = -1;
+    }
+    return { std::max(r.lo, -1.0), std::min(r.hi, 1.0) };
+}
+
+inline Interval exp(const Interval& x) {
+    const auto r = detail::outward2(std::exp(x.lo), std::exp(x.hi));
+    return { std::max(r.lo, 0.0), r.hi };
+}
+
+inline Interval log(const Interval& x) {
+    if (x.hi < 0) {
+        return detail::nan_interval();
+    }
+    return detail::outward2(std::log(std::max(x.lo, 0.0)), std::log(x.hi));
+}
+
+inline Interval abs(const Interval& x) {
+    if (x.lo >= 0) {
+        return x;
+    }
+    if (x.hi <= 0) {
+        return -x;
+    }
+    return { 0, std::max(-x.lo, x.hi) };
+}
+
+} // namespace interval
+
+
+// any other functional has no interval extension
+template <Functional F, class... X>
+Interval enclose(const F&, X...) {
+    static_assert(sizeof(F) == 0, "no interval evaluation for this node");
+    return {};
+}
+
+template <uint64_t N, class... X>
+Interval enclose(Variable<N>, X... x) {
+    static_assert(sizeof...(X) > N, "not enough arguments");
+    return std::get<N>(std::make_tuple(Interval{ x }...));
+}
+
+template <Arithmetic auto C, class... X>
+Interval enclose(Constant<C>, X...) {
+    return static_cast<double>(C);
+}
+
+template <Arithmetic T, class... X>
+Interval enclose(const RTConstant<T>& c, X...) {
+    return static_cast<double>(c.value);
+}
+
+template <Functional F, class... X>
+Interval enclose(const Negate<F>& f, X... x) {
+    return -enclose(f.f(), x...);
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Add<F1, F2>& f, X... x) {
+    return enclose(f.f1(), x...) + enclose(f.f2(), x...);
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Sub<F1, F2>& f, X... x) {
+    return enclose(f.f1(), x...) - enclose(f.f2(), x...);
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Mul<F1, F2>& f, X... x) {
+    return enclose(f.f1(), x...) * enclose(f.f2(), x...);
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Div<F1, F2>& f, X... x) {
+    return enclose(f.f1(), x...) / enclose(f.f2(), x...);
+}
+
+template <Functional... Fs, class... X>
+Interval enclose(const Sum<Fs...>& f, X... x) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return (enclose(f.template term<idx>(), x...) + ...);
+    }(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+template <Functional... Fs, class... X>
+Interval enclose(const Product<Fs...>& f, X... x) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return (enclose(f.template term<idx>(), x...) * ...);
+    }(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+template <Functional F, Functional... Gs, class... X>
+Interval enclose(const App<F, Gs...>& ap, X... x) {
+    const auto xs = utils::forward_as_view(x...);
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return utils::apply([&ap](auto... args) {
+            return enclose(ap.f(), Interval{ args }...);
+        }, utils::concat(utils::forward_as_view(enclose(ap.template g<idx>(), x...)...),
+                         utils::split<sizeof...(Gs)>(xs).second));
+    }(std::make_index_sequence<sizeof...(Gs)>{});
+}
+
+template <Arithmetic auto C, class X, class... Xs>
+Interval enclose(Pow<C>, X x, Xs...) {
+    if constexpr (std::is_integral_v<decltype(C)>) {
+        return interval::pow(Interval{ x }, int64_t(C));
+    } else {
+        return interval::pow(Interval{ x }, double(C));
+    }
+}
+
+template <Arithmetic T, class X, class... Xs>
+Interval enclose(const RTPow<T>& p, X x, Xs...) {
+    return interval::pow(Interval{ x }, double(p.deg()));
+}
+
+template <class X, class... Xs>
+Interval enclose(Sin, X x, Xs...) {
+    return interval::sin(Interval{ x });
+}
+
+template <class X, class... Xs>
+Interval enclose(Cos, X x, Xs...) {
+    return interval::cos(Interval{ x });
+}
+
+template <class X, class... Xs>
+Interval enclose(Exp, X x, Xs...) {
+    return interval::exp(Interval{ x });
+}
+
+template <class X, class... Xs>
+Interval enclose(Log, X x, Xs...) {
+    return interval::log(Interval{ x });
+}
+
+template <class X, class... Xs>
+Interval enclose(Abs, X x, Xs...) {
+    return interval::abs(Interval{ x });
+}
+
+template <class X, class... Xs>
+Interval enclose(Sign, X x, Xs...) {
+    const Interval v{ x };
+    return { Sign{}(v.lo), Sign{}(v.hi) };
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Min<F1, F2>& f, X... x) {
+    const auto a = enclose(f.f1(), x...);
+    const auto b = enclose(f.f2(), x...);
+    return { std::min(a.lo, b.lo), std::min(a.hi, b.hi) };
+}
+
+template <Functional F1, Functional F2, class... X>
+Interval enclose(const Max<F1, F2>& f, X... x) {
+    const auto a = enclose(f.f1(), x...);
+    const auto b = enclose(f.f2(), x...);
+    return { std::max(a.lo, b.lo), std::max(a.hi, b.hi) };
+}
+
+template <Functional F, Functional Lo, Functional Hi, class... X>
+Interval enclose(const Clamp<F, Lo, Hi>& f, X... x) {
+    const auto v = enclose(f.f(), x...);
+    const auto l = enclose(f.lo(), x...);
+    const auto h = enclose(f.hi(), x...);
+    // min(max(v, l), h), which equals the selects wherever l <= h
+    const Interval above{ std::max(v.lo, l.lo), std::max(v.hi, l.hi) };
+    return { std::min(above.lo, h.lo), std::min(above.hi, h.hi) };
+}
+
+template <Functional Cond, Functional F, Functional G, class... X>
+Interval enclose(const Select<Cond, F, G>& f, X... x) {
+    const auto c = enclose(f.cond(), x...);
+    if (c.lo > 0) {
+        return enclose(f.f(), x...);
+    }
+    if (c.hi <= 0) {
+        return enclose(f.g(), x...);
+    }
+    // either piece, or both: the hull
+    const auto a = enclose(f.f(), x...);
+    const auto b = enclose(f.g(), x...);
+    return { std::min(a.lo, b.lo), std::max(a.hi, b.hi) };
+}
+
+/**
+ * Enclosure of f over the box: variable i ranges over box[i]
+ */
+template <Functional F, size_t N>
+requires NVariablesFunctional<N, F>
+Interval bound(const F& f, const Box<N>& box) {
+    return std::apply([&](const auto&... x) { return enclose(f, x...); }, box);
+}
+
+
+enum class BranchAndBoundStatus : uint8_t {
+    Converged,
+    MaxBoxes // the box budget ran out first
+};
+
+struct GlobalMinimumOptions {
+    double tolerance = 1e-8;      // on value - lower_bound, relative to max(1, |value|)
+    double box_tolerance = 1e-12; // boxes narrower than this are not split, relative to the domain
+    uint64_t max_boxes = 1'000'000;
+};
+
+template <size_t N>
+struct GlobalMinimum {
+    std::array<double, N> x; // best point found
+    double value;            // f(x)
+    double lower_bound;      // f >= lower_bound over the whole box
+    uint64_t boxes;          // boxes bounded
+    BranchAndBoundStatus status;
+};
+
+struct RootIsolationOptions {
+    double tolerance = 1e-10; // width of the reported intervals
+    uint64_t max_boxes = 1'000'000; // intervals examined; those left are reported unsplit
+};
+
+struct RootInterval {
+    Interval x;
+    bool unique; // exactly one zero of f in x
+};
+
+namespace detail {
+
+template <size_t N>
+struct BoundedBox {
+    Box<N> box;
+    double lower;
+
+    // min heap by lower bound
+    friend constexpr bool operator < (const BoundedBox& l, const BoundedBox& r) {
+        return l.lower > r.lower;
+    }
+};
+
+template <size_t N>
+std::pair<Box<N>, Box<N>> bisect(const Box<N>& box) {
+    size_t widest = 0;
+    for (size_t i = 1; i < N; ++i) {
+        if (box[i].width() > box[widest].width()) {
+            widest = i;
+        }
+    }
+    auto left = box, right = box;
+    const double middle = box[widest].midpoint();
+    left[widest].hi = middle;
+    right[widest].lo = middle;
+    return { left, right };
+}
+
+template <size_t N>
+std::array<double, N> midpoint(const Box<N>& box) {
+    std::array<double, N> x;
+    for (size_t i = 0; i < N; ++i) {
+        x[i] = box[i].midpoint();
+    }
+    return x;
+}
+
+// boxes of a parallel round per thread: enough work to amortize the round
+constexpr size_t kBoxesPerThread = 16;
+
+} // namespace detail
+
+
+/**
+ * Global minimum of f over the box, see the top of the file
+ */
+template <size_t N, Functional F>
+requires NVariablesFunctional<N, F>
+GlobalMinimum<N> minimize_global(const F& f, const Box<N>& box,
+                                 const GlobalMinimumOptions& options = {}) {
+    using Candidate = detail::BoundedBox<N>;
+    constexpr double inf = std::numeric_limits<double>::infinity();
+
+    struct Child {
+        Candidate candidate;
+        std::array<double, N> x;
+        double value;
+    };
+    const auto partials = [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return std::make_tuple(diff(f, Variable<idx>{})...);
+    }(std::make_index_sequence<N>{});
+
+    const auto process = [&](const Box<N>& b) {
+        const auto x = detail::midpoint(b);
+        const double value = std::apply([&](auto... v) {
+            return static_cast<double>(evaluate(f, v...));
+        }, x);
+        // mean value form f(m) + grad f(b) (b - m): its overestimation
+        // shrinks with the square of the width, the natural one's linearly
+        Box<N> m;
+        for (size_t i = 0; i < N; ++i) {
+            m[i] = Interval{ x[i] };
+        }
+        auto mean_value = bound(f, m);
+        [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            ((mean_value = mean_value + bound(std::get<idx>(partials), b) * (b[idx] - m[idx])), ...);
+        }(std::make_index_sequence<N>{});
+        // NaN bounds, for boxes leaving the domain of f, do not prune
+        const double lower = std::max(bound(f, b).lo, mean_value.lo);
+        return Child{ { b, std::isnan(lower) ? -inf : lower }, x, value };
+    };
+
+    double smallest = inf;
+    for (const auto& side : box) {
+        smallest = std::min(smallest, side.width());
+    }
+    const double min_width = options.box_tolerance * std::max(smallest, 1e-300);
+
+    auto& pool = utils::default_thread_pool();
+    const size_t round = detail::kBoxesPerThread * pool.size();
+
+    const auto first = process(box);
+    GlobalMinimum<N> result{ first.x, std::isnan(first.value) ? inf : first.value,
+                             first.candidate.lower, 1, BranchAndBoundStatus::Converged };
+    // lower bounds of boxes too small to split
+    double settled = inf;
+    std::vector<Candidate> heap{ first.candidate };
+    std::vector<Candidate> batch;
+    std::vector<Child> children;
+    while (true) {
+        const double lowest = std::min(heap.empty() ? inf : heap.front().lower, settled);
+        result.lower_bound = std::min(lowest, result.value);
+        if (result.value - result.lower_bound <=
+            options.tolerance * std::max(1.0, std::abs(result.value))) {
+            result.status = BranchAndBoundStatus::Converged;
+            return result;
+        }
+        if (result.boxes >= options.max_boxes) {
+            result.status = BranchAndBoundStatus::MaxBoxes;
+            return result;
+        }
+
+        batch.clear();
+        while (!heap.empty() && batch.size() < round) {
+            std::pop_heap(heap.begin(), heap.end());
+            batch.push_back(heap.back());
+            heap.pop_back();
+        }
+        children.resize(2 * batch.size());
+        pool.parallel_for(batch.size(), [&](size_t i) {
+            const auto [left, right] = detail::bisect(batch[i].box);
+            children[2 * i] = process(left);
+            children[2 * i + 1] = process(right);
+        }, 1);
+        result.boxes += children.size();
+
+        // in the order of the batch: results do not depend on scheduling
+        for (const auto& child : children) {
+            if (child.value < result.value) {
+                result.value = child.value;
+                result.x = child.x;
+            }
+        }
+        for (const auto& child : children) {
+            const auto& c = child.candidate;
+            if (c.lower > result.value) {
+                continue;
+            }
+            double widest = 0;
+            for (const auto& side : c.box) {
+                widest = std::max(widest, side.width());
+            }
+            if (widest <= min_width) {
+                settled = std::min(settled, c.lower);
+                continue;
+            }
+            heap.push_back(c);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+}
+
+/**
+ * Intervals of width at most options.tolerance, in increasing order,
+ * containing all zeros of f in domain; see the top of the file.
+ * Intervals are not merged: a zero on the edge of two may be reported twice.
+ */
+template <Functional F>
+requires NVariablesFunctional<1, F>
+std::vector<RootInterval> isolate_roots(const F& f, const Interval& domain,
+                                        const RootIsolationOptions& options = {}) {
+    const auto derivative = diff(f, Variable<0>{});
+
+    enum class Verdict : uint8_t { Discard, Split, Report };
+    struct Outcome {
+        Verdict verdict;
+        bool unique;
+    };
+    const auto examine = [&](const Interval& x) {
+        const auto fx = enclose(f, x);
+        if (fx.valid() && !fx.contains(0)) {
+            return Outcome{ Verdict::Discard, false };
+        }
+        bool unique = false;
+        const auto dx = enclose(derivative, x);
+        if (dx.valid() && !dx.contains(0)) {
+            // monotone: the signs at the ends decide
+            const auto a = enclose(f, Interval{ x.lo });
+            const auto b = enclose(f, Interval{ x.hi });
+            if ((a.lo > 0 && b.lo > 0) || (a.hi < 0 && b.hi < 0)) {
+                return Outcome{ Verdict::Discard, false };
+            }
+            unique = (a.hi < 0 && b.lo > 0) || (a.lo > 0 && b.hi < 0);
+        }
+        if (x.width() <= options.tolerance) {
+            return Outcome{ Verdict::Report, unique };
+        }
+        return Outcome{ Verdict::Split, unique };
+    };
+
+    std::vector<RootInterval> roots;
+    std::vector<Interval> frontier{ domain }, next;
+    std::vector<Outcome> outcomes;
+    uint64_t boxes = 0;
+    auto& pool = utils::default_thread_pool();
+    while (!frontier.empty()) {
+        // no more than the budget left: the rest of the level is reported unsplit
+        const size_t examined = std::min<uint64_t>(frontier.size(), options.max_boxes - boxes);
+        outcomes.assign(frontier.size(), Outcome{ Verdict::Report, false });
+        pool.parallel_for(examined, [&](size_t i) {
+            outcomes[i] = examine(frontier[i]);
+        });
+        boxes += examined;
+        const bool exhausted = boxes >= options.max_boxes;
+
+        next.clear();
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            const auto& x = frontier[i];
+            switch (outcomes[i].verdict) {
+            case Verdict::Discard:
+                break;
+            case Verdict::Report:
+                roots.push_back({ x, outcomes[i].unique });
+                break;
+            case Verdict::Split:
+                if (exhausted) {
+                    // out of budget: report as is
+                    roots.push_back({ x, outcomes[i].unique });
+                } else {
+                    const double middle = x.midpoint();
+                    next.push_back({ x.lo, middle });
+                    next.push_back({ middle, x.hi });
+                }
+                break;
+            }
+        }
+        std::swap(frontier, next);
+    }
+    std::sort(roots.begin(), roots.end(), [](const auto& a, const auto& b) {
+        return a.x.lo < b.x.lo;
+    });
+    return roots;
+}
+
+} // veritacpp::dsl::math
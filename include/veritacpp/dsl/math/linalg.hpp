@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Dense linear algebra for the small fixed size systems of the solvers:
+ * normal equations of fits, Newton systems of implicit integrators.
+ * Sizes are template parameters, storage is std::array, nothing allocates.
+ */
+namespace veritacpp::dsl::math::linalg {
+
+template <size_t N>
+using Vector = std::array<double, N>;
+
+// row major: a[row][column]
+template <size_t N>
+using Matrix = std::array<std::array<double, N>, N>;
+
+template <size_t N>
+constexpr Matrix<N> identity() {
+    Matrix<N> m{};
+    for (size_t i = 0; i < N; ++i) {
+        m[i][i] = 1;
+    }
+    return m;
+}
+
+template <size_t N>
+constexpr Vector<N> multiply(const Matrix<N>& a, const Vector<N>& x) {
+    Vector<N> r{};
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            r[i] += a[i][j] * x[j];
+        }
+    }
+    return r;
+}
+
+/**
+ * Solves a x = b for symmetric positive definite a, only the lower
+ * triangle of a is read. b is replaced by x.
+ * Returns false if a is not positive definite (numerically).
+ */
+template <size_t N>
+constexpr bool cholesky_solve(Matrix<N> a, Vector<N>& b) {
+    // a = l l^T, l overwrites the lower triangle
+    for (size_t j = 0; j < N; ++j) {
+        double d = a[j][j];
+        for (size_t k = 0; k < j; ++k) {
+            d -= a[j][k] * a[j][k];
+        }
+        if (!(d > 0)) {
+            return false;
+        }
+        a[j][j] = std::sqrt(d);
+        for (size_t i = j + 1; i < N; ++i) {
+            double s = a[i][j];
+            for (size_t k = 0; k < j; ++k) {
+                s -= a[i][k] * a[j][k];
+            }
+            a[i][j] = s / a[j][j];
+        }
+    }
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t k = 0; k < i; ++k) {
+            b[i] -= a[i][k] * b[k];
+        }
+        b[i] /= a[i][i];
+    }
+    for (size_t i = N; i-- > 0;) {
+        for (size_t k = i + 1; k < N; ++k) {
+            b[i] -= a[k][i] * b[k];
+        }
+        b[i] /= a[i][i];
+    }
+    return true;
+}
+
+/**
+ * LU decomposition with partial pivoting, for repeated solutions
+ * with the same matrix
+ */
+template <size_t N>
+struct LU {
+    Matrix<N> lu;
+    std::array<size_t, N> pivot;
+    bool singular = false;
+
+    constexpr explicit LU(const Matrix<N>& a) : lu{a} {
+        for (size_t i = 0; i < N; ++i) {
+            pivot[i] = i;
+        }
+        for (size_t j = 0; j < N; ++j) {
+            size_t p = j;
+            for (size_t i = j + 1; i < N; ++i) {
+                if (std::abs(lu[i][j]) > std::abs(lu[p][j])) {
+                    p = i;
+                }
+            }
+            if (lu[p][j] == 0) {
+                singular = true;
+                return;
+            }
+            std::swap(lu[p], lu[j]);
+            std::swap(pivot[p], pivot[j]);
+            for (size_t i = j + 1; i < N; ++i) {
+                lu[i][j] /= lu[j][j];
+                for (size_t k = j + 1; k < N; ++k) {
+                    lu[i][k] -= lu[i][j] * lu[j][k];
+                }
+            }
+        }
+    }
+
+    // x with a x = b; precondition: !singular
+    constexpr Vector<N> solve(const Vector<N>& b) const {
+        Vector<N> x;
+        for (size_t i = 0; i < N; ++i) {
+            x[i] = b[pivot[i]];
+            for (size_t k = 0; k < i; ++k) {
+                x[i] -= lu[i][k] * x[k];
+            }
+        }
+        for (size_t i = N; i-- > 0;) {
+            for (size_t k = i + 1; k < N; ++k) {
+                x[i] -= lu[i][k] * x[k];
+            }
+            x[i] /= lu[i][i];
+        }
+        return x;
+    }
+};
+
+} // veritacpp::dsl::math::linalg
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/philox.hpp>
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Monte Carlo estimates of the mean and variance of f(X_0, ..., X_{N-1})
+ * for independent random X_j.
+ *
+ *   // E[max(S - K, 0)] for a lognormal S = Variable<0>
+ *   auto m = monte_carlo(max(s - 100.0, 0.0), 1'000'000, LogNormal{ 4.6, 0.2 });
+ *
+ * Variable j of f is drawn from the j-th distribution. Draws come from
+ * the Philox counter based generator (utils/philox.hpp): the draw of
+ * sample i, variable j is a function of (seed, j, i) only. Samples are
+ * made in blocks, evaluated by one loop per block (vectorized with
+ * FastMath) and summarized per block; block summaries are merged in
+ * block order. The result is therefore bit for bit the same for a given
+ * seed whatever the number of threads. Blocks run on options.pool, by
+ * default utils::default_thread_pool().
+ */
+namespace veritacpp::dsl::math {
+
+// maps two independent uniforms in (0, 1] to a draw
+template <class D>
+concept Distribution = requires(const D& d, double u0, double u1) {
+    { d.sample(u0, u1) } -> std::convertible_to<double>;
+};
+
+struct Uniform {
+    double lo = 0;
+    double hi = 1;
+
+    constexpr double sample(double u0, double) const {
+        return hi - (hi - lo) * u0;
+    }
+};
+
+struct Normal {
+    double mean = 0;
+    double deviation = 1;
+
+    // Box-Muller, one of the pair of normals is kept
+    double sample(double u0, double u1) const {
+        const double z = std::sqrt(-2 * std::log(u0)) * std::cos(2 * std::numbers::pi * u1);
+        return mean + deviation * z;
+    }
+};
+
+// exp of Normal{ mu, sigma }
+struct LogNormal {
+    double mu = 0;
+    double sigma = 1;
+
+    double sample(double u0, double u1) const {
+        return std::exp(Normal{ mu, sigma }.sample(u0, u1));
+    }
+};
+
+struct Exponential {
+    double rate = 1;
+
+    double sample(double u0, double) const {
+        return -std::log(u0) / rate;
+    }
+};
+
+struct MonteCarloOptions {
+    uint64_t seed = 0;
+    utils::ThreadPool* pool = nullptr; // nullptr: the default pool
+};
+
+enum class MonteCarloStatus : uint8_t {
+    Success,
+    NotFinite,    // f was not finite for some sample
+    TooFewSamples // under 2 samples: variance and error are NaN, and so is the mean for 0
+};
+
+struct MonteCarlo {
+    double mean;
+    double variance;  // of f, unbiased
+    double error;     // standard error of the mean
+    uint64_t samples;
+    MonteCarloStatus status;
+};
+
+namespace detail {
+
+constexpr size_t kMonteCarloBlock = 4096;
+
+// count, mean and sum of squared deviations of a set of values
+struct Moments {
+    double count = 0;
+    double mean = 0;
+    double m2 = 0;
+
+    // union of two sets (Chan et al.)
+    constexpr Moments merge(const Moments& other) const {
+        const double n = count + other.count;
+        if (n == 0) {
+            return {};
+        }
+        const double delta = other.mean - mean;
+        return { n, mean + delta * (other.count / n),
+                 m2 + other.m2 + delta * delta * (count * other.count / n) };
+    }
+};
+
+template <class Policy, class F, class Distributions>
+Moments monte_carlo_block(const F& f, const Distributions& distributions, uint64_t seed,
+                          uint64_t first, size_t count) {
+    constexpr size_t N = std::tuple_size_v<Distributions>;
+    std::array<std::array<double, kMonteCarloBlock>, N> x;
+    std::array<double, kMonteCarloBlock> fx;
+    [&]<uint64_t... j>(std::integer_sequence<uint64_t, j...>) {
+        // variable j is stream j of the seed, sample i its element i
+        const auto draw = [&](auto stream, const auto& d, auto& column) {
+            for (size_t i = 0; i < count; ++i) {
+                const auto u = utils::Philox4x32::uniform(seed, stream, first + i);
+                column[i] = d.sample(u[0], u[1]);
+            }
+        };
+        (draw(j, std::get<j>(distributions), x[j]), ...);
+        for (size_t i = 0; i < count; ++i) {
+            fx[i] = static_cast<double>(evaluate<Policy>(f, x[j][i]...));
+        }
+    }(std::make_index_sequence<N>{});
+
+    // two passes: no cancellation within the block
+    double sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += fx[i];
+    }
+    const double mean = sum / double(count);
+    double m2 = 0;
+    for (size_t i = 0; i < count; ++i) {
+        m2 += (fx[i] - mean) * (fx[i] - mean);
+    }
+    return { double(count), mean, m2 };
+}
+
+} // namespace detail
+
+/**
+ * Mean and variance of f over samples draws of its variables,
+ * see the top of the file
+ */
+template <class Policy = Precise, Functional F, Distribution... D>
+requires NVariablesFunctional<sizeof...(D), F>
+MonteCarlo monte_carlo(const F& f, uint64_t samples, const MonteCarloOptions& options,
+                       const D&... distributions) {
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    if (samples == 0) {
+        return { nan, nan, nan, 0, MonteCarloStatus::TooFewSamples };
+    }
+    constexpr size_t block = detail::kMonteCarloBlock;
+    const auto d = std::make_tuple(distributions...);
+    const size_t blocks = (samples + block - 1) / block;
+    std::vector<detail::Moments> partial(blocks);
+    auto& pool = options.pool ? *options.pool : utils::default_thread_pool();
+    pool.parallel_for(blocks, [&](size_t b) {
+        const uint64_t first = b * block;
+        partial[b] = detail::monte_carlo_block<Policy>(f, d, options.seed, first,
+                                                       std::min<uint64_t>(block, samples - first));
+    }, 1);
+
+    detail::Moments total;
+    for (const auto& m : partial) {
+        total = total.merge(m);
+    }
+    const double n = double(samples);
+    if (!std::isfinite(total.mean) || !std::isfinite(total.m2)) {
+        return { total.mean, nan, nan, samples, MonteCarloStatus::NotFinite };
+    }
+    if (samples == 1) {
+        // the unbiased variance of a single draw is undefined
+        return { total.mean, nan, nan, samples, MonteCarloStatus::TooFewSamples };
+    }
+    const double variance = total.m2 / (n - 1);
+    return { total.mean, variance, std::sqrt(variance / n), samples, MonteCarloStatus::Success };
+}
+
+template <class Policy = Precise, Functional F, Distribution... D>
+requires NVariablesFunctional<sizeof...(D), F>
+MonteCarlo monte_carlo(const F& f, uint64_t samples, const D&... distributions) {
+    return monte_carlo<Policy>(f, samples, MonteCarloOptions{}, distributions...);
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Dynamics of particles interacting through a pair potential.
+ *
+ * The potential V is a Functional of the distance r = Variable<0>.
+ * Forces come from its derivative, built once by diff:
+ *   F_i = sum over j != i of -V'(r_ij) / r_ij * (x_i - x_j)
+ * Pairs at distance cutoff or more do not interact. In a periodic box
+ * particles interact with the nearest image of the others, which
+ * requires a cutoff of at most half the box.
+ *
+ * compute_forces(V, particles, options) fills the forces,
+ * potential_energy(V, particles, options) sums V over the pairs, and
+ * velocity_verlet(V, particles, dt, steps, options) advances the
+ * system by the symplectic velocity Verlet (leapfrog) scheme: the
+ * energy error stays bounded over long runs instead of drifting.
+ *
+ * Pairs are found with a cell list: space is cut into cells no smaller
+ * than the cutoff, particles are sorted by cell, and a particle only
+ * meets those of its own and the neighbouring cells. Without a cutoff
+ * there is a single cell and all N^2 pairs are evaluated.
+ * The candidates of a particle are processed in lanes: distances,
+ * the kernel and the sums are separate loops without branches, which
+ * the compiler vectorizes with FastMath policies. Cells are processed
+ * in parallel and every particle sums its own force, so every pair is
+ * evaluated twice but threads never write to the same particle.
+ */
+namespace veritacpp::dsl::math {
+
+/**
+ * Particles in three dimensions, stored by component:
+ * position(a) points to coordinate a of all particles, contiguously
+ */
+class Particles {
+public:
+    explicit Particles(size_t n) : n_{ n }, data_(10 * n) {
+        std::fill_n(mass(), n, 1.0);
+    }
+
+    size_t size() const { return n_; }
+
+    double* position(size_t axis) { return component(axis); }
+    const double* position(size_t axis) const { return component(axis); }
+
+    double* velocity(size_t axis) { return component(3 + axis); }
+    const double* velocity(size_t axis) const { return component(3 + axis); }
+
+    // as of the last compute_forces or velocity_verlet
+    double* force(size_t axis) { return component(6 + axis); }
+    const double* force(size_t axis) const { return component(6 + axis); }
+
+    double* mass() { return component(9); }
+    const double* mass() const { return component(9); }
+
+private:
+    double* component(size_t i) { return data_.data() + i * n_; }
+    const double* component(size_t i) const { return data_.data() + i * n_; }
+
+    size_t n_;
+    std::vector<double> data_;
+};
+
+struct NBodyOptions {
+    double cutoff = std::numeric_limits<double>::infinity();
+    double box = 0; // side of the periodic cube [0, box)^3, 0: open space
+};
+
+enum class NBodyStatus : uint8_t {
+    Success,
+    CutoffTooLarge // periodic box smaller than two cutoffs: nearest images are ambiguous
+};
+
+namespace detail {
+
+// pairs of a particle processed together
+constexpr size_t kNBodyLanes = 16;
+
+/**
+ * Particles sorted by cell: the particles of cell c are
+ * order[start[c]] ... order[start[c + 1] - 1],
+ * and their positions are sorted[a][start[c]] ...
+ */
+struct CellList {
+    std::array<size_t, 3> dims{ 1, 1, 1 };
+    std::array<double, 3> origin{};
+    std::array<double, 3> inverse_side{};
+    std::vector<size_t> start;
+    std::vector<size_t> order;
+    std::vector<size_t> cell_of;
+    std::array<std::vector<double>, 3> sorted;
+
+    size_t cells() const {
+        return dims[0] * dims[1] * dims[2];
+    }
+};
+
+inline NBodyStatus check(const NBodyOptions& options) {
+    const bool periodic = options.box > 0;
+    return periodic && !(2 * options.cutoff <= options.box) ? NBodyStatus::CutoffTooLarge
+                                                            : NBodyStatus::Success;
+}
+
+// x wrapped into [0, box)
+inline double wrap(double x, double box) {
+    const double w = x - box * std::floor(x / box);
+    return w < box ? w : 0;
+}
+
+inline void build_cells(CellList& cells, const Particles& p, const NBodyOptions& options) {
+    const size_t n = p.size();
+    const bool periodic = options.box > 0;
+    // no more cells than about 8 per particle: sparse systems waste no memory
+    const double cap = std::max(1.0, 2 * std::cbrt(double(n)));
+    for (size_t a = 0; a < 3; ++a) {
+        double extent = options.box;
+        cells.origin[a] = 0;
+        if (!periodic) {
+            const auto [lo, hi] = std::minmax_element(p.position(a), p.position(a) + n);
+            cells.origin[a] = n > 0 ? *lo : 0;
+            extent = n > 0 ? *hi - *lo : 0;
+        }
+        // cells are at least a cutoff wide
+        const double fit = std::floor(extent / options.cutoff);
+        cells.dims[a] = size_t(std::clamp(std::isfinite(fit) ? fit : 1.0, 1.0, cap));
+        cells.inverse_side[a] = extent > 0 ? double(cells.dims[a]) / extent : 0;
+    }
+
+    cells.cell_of.resize(n);
+    cells.start.assign(cells.cells() + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        size_t c = 0;
+        for (size_t a = 0; a < 3; ++a) {
+            double x = p.position(a)[i];
+            if (periodic) {
+                x = wrap(x, options.box);
+            }
+            const double s = (x - cells.origin[a]) * cells.inverse_side[a];
+            c = c * cells.dims[a] + std::min(cells.dims[a] - 1, size_t(std::max(0.0, s)));
+        }
+        cells.cell_of[i] = c;
+        ++cells.start[c + 1];
+    }
+    for (size_t c = 0; c < cells.cells(); ++c) {
+        cells.start[c + 1] += cells.start[c];
+    }
+
+    // counting sort, stable: particles of a cell keep their order
+    cells.order.resize(n);
+    std::vector<size_t> next(cells.start.begin(), cells.start.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        cells.order[next[cells.cell_of[i]]++] = i;
+    }
+    for (size_t a = 0; a < 3; ++a) {
+        cells.sorted[a].resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            cells.sorted[a][k] = p.position(a)[cells.order[k]];
+        }
+    }
+}
+
+// distinct cells next to cell c, c included
+inline std::pair<std::array<size_t, 27>, size_t> neighbour_cells(const CellList& cells,
+                                                                 size_t c, bool periodic) {
+    std::array<std::array<size_t, 3>, 3> near;
+    std::array<size_t, 3> count{};
+    for (size_t a = 3; a-- > 0;) {
+        const size_t d = cells.dims[a];
+        const size_t i = c % d;
+        c /= d;
+        // i - 1, i, i + 1, shifted by d to stay unsigned
+        for (const size_t j : { i + d - 1, i + d, i + d + 1 }) {
+            if (!periodic && (j < d || j >= 2 * d)) {
+                continue;
+            }
+            const size_t wrapped = j % d;
+            if (std::find(near[a].begin(), near[a].begin() + count[a], wrapped) ==
+                near[a].begin() + count[a]) {
+                near[a][count[a]++] = wrapped;
+            }
+        }
+    }
+    std::array<size_t, 27> result;
+    size_t n = 0;
+    for (size_t i = 0; i < count[0]; ++i) {
+        for (size_t j = 0; j < count[1]; ++j) {
+            for (size_t k = 0; k < count[2]; ++k) {
+                result[n++] = (near[0][i] * cells.dims[1] + near[1][j]) * cells.dims[2] + near[2][k];
+            }
+        }
+    }
+    return { result, n };
+}
+
+using NBodyLane = std::array<double, kNBodyLanes>;
+
+/**
+ * Calls body(count, dx, dy, dz, near) for lanes of the candidates of
+ * the k-th sorted particle: the separations x_k - x_j of count pairs,
+ * nearest images in a periodic box, and near[l] = r_l^2 for pairs
+ * closer than the cutoff, 0 for the others and the particle itself.
+ */
+template <class Body>
+void for_pair_lanes(const CellList& cells, const std::array<size_t, 27>& neighbours,
+                    size_t neighbour_count, size_t k, const NBodyOptions& options, Body&& body) {
+    const double box = options.box;
+    const double inverse_box = box > 0 ? 1 / box : 0;
+    const double cutoff2 = options.cutoff * options.cutoff;
+    const double xk = cells.sorted[0][k];
+    const double yk = cells.sorted[1][k];
+    const double zk = cells.sorted[2][k];
+    NBodyLane dx, dy, dz, near;
+    for (size_t m = 0; m < neighbour_count; ++m) {
+        const size_t end = cells.start[neighbours[m] + 1];
+        for (size_t first = cells.start[neighbours[m]]; first < end; first += kNBodyLanes) {
+            const size_t count = std::min(kNBodyLanes, end - first);
+            const double* const xs = cells.sorted[0].data() + first;
+            const double* const ys = cells.sorted[1].data() + first;
+            const double* const zs = cells.sorted[2].data() + first;
+            for (size_t l = 0; l < count; ++l) {
+                // in open space box and inverse_box are 0 and nothing is shifted
+                dx[l] = xk - xs[l];
+                dy[l] = yk - ys[l];
+                dz[l] = zk - zs[l];
+                dx[l] -= box * std::nearbyint(dx[l] * inverse_box);
+                dy[l] -= box * std::nearbyint(dy[l] * inverse_box);
+                dz[l] -= box * std::nearbyint(dz[l] * inverse_box);
+                const double r2 = dx[l] * dx[l] + dy[l] * dy[l] + dz[l] * dz[l];
+                near[l] = r2 < cutoff2 && r2 > 0 ? r2 : 0;
+            }
+            body(count, dx, dy, dz, near);
+        }
+    }
+}
+
+// calls f(k, sums) for every sorted particle, cells in parallel
+template <class F>
+void for_each_particle(const CellList& cells, const NBodyOptions& options, F&& f) {
+    utils::default_thread_pool().parallel_for(cells.cells(), [&](size_t c) {
+        const auto [neighbours, count] = neighbour_cells(cells, c, options.box > 0);
+        for (size_t k = cells.start[c]; k < cells.start[c + 1]; ++k) {
+            f(k, neighbours, count);
+        }
+    });
+}
+
+template <class Policy, Functional K>
+void pair_forces(const K& kernel, const CellList& cells, Particles& p,
+                 const NBodyOptions& options) {
+    for_each_particle(cells, options, [&](size_t k, const auto& neighbours, size_t count) {
+        // per lane sums: adding lanes together is left out of the inner loop
+        NBodyLane fx{}, fy{}, fz{};
+        for_pair_lanes(cells, neighbours, count, k, options,
+                       [&](size_t lanes, const NBodyLane& dx, const NBodyLane& dy,
+                           const NBodyLane& dz, const NBodyLane& near) {
+            for (size_t l = 0; l < lanes; ++l) {
+                const double r = std::sqrt(near[l] > 0 ? near[l] : 1.0);
+                const double w = static_cast<double>(evaluate<Policy>(kernel, r));
+                const double s = near[l] > 0 ? w : 0;
+                fx[l] += s * dx[l];
+                fy[l] += s * dy[l];
+                fz[l] += s * dz[l];
+            }
+        });
+        const size_t i = cells.order[k];
+        p.force(0)[i] = pairwise_reduce(fx, std::plus<>{});
+        p.force(1)[i] = pairwise_reduce(fy, std::plus<>{});
+        p.force(2)[i] = pairwise_reduce(fz, std::plus<>{});
+    });
+}
+
+// -V'(r) / r: force on a particle per unit of separation
+template <Functional V>
+constexpr Functional auto pair_force_kernel(const V& v) {
+    constexpr auto r = Variable<0>{};
+    return -diff(v, r) / r;
+}
+
+} // namespace detail
+
+/**
+ * Forces on all particles, see the top of the file
+ */
+template <class Policy = Precise, Functional V>
+requires NVariablesFunctional<1, V>
+NBodyStatus compute_forces(const V& v, Particles& particles, const NBodyOptions& options = {}) {
+    if (const auto status = detail::check(options); status != NBodyStatus::Success) {
+        return status;
+    }
+    detail::CellList cells;
+    detail::build_cells(cells, particles, options);
+    detail::pair_forces<Policy>(detail::pair_force_kernel(v), cells, particles, options);
+    return NBodyStatus::Success;
+}
+
+/**
+ * Sum of V(r_ij) over pairs i < j closer than the cutoff,
+ * NaN if the options are invalid
+ */
+template <class Policy = Precise, Functional V>
+requires NVariablesFunctional<1, V>
+double potential_energy(const V& v, const Particles& particles, const NBodyOptions& options = {}) {
+    if (detail::check(options) != NBodyStatus::Success) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    detail::CellList cells;
+    detail::build_cells(cells, particles, options);
+    // sums per particle, added in a fixed order: the result does not depend on threads
+    std::vector<double> energy(particles.size());
+    detail::for_each_particle(cells, options, [&](size_t k, const auto& neighbours, size_t count) {
+        detail::NBodyLane e{};
+        detail::for_pair_lanes(cells, neighbours, count, k, options,
+                               [&](size_t lanes, const auto&, const auto&, const auto&,
+                                   const detail::NBodyLane& near) {
+            for (size_t l = 0; l < lanes; ++l) {
+                const double r = std::sqrt(near[l] > 0 ? near[l] : 1.0);
+                const double u = static_cast<double>(evaluate<Policy>(v, r));
+                e[l] += near[l] > 0 ? u : 0;
+            }
+        });
+        energy[k] = detail::pairwise_reduce(e, std::plus<>{});
+    });
+    double sum = 0;
+    for (const double e : energy) {
+        sum += e;
+    }
+    // every pair was counted from both sides
+    return sum / 2;
+}
+
+inline double kinetic_energy(const Particles& p) {
+    double sum = 0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        const double v2 = p.velocity(0)[i] * p.velocity(0)[i] +
+                          p.velocity(1)[i] * p.velocity(1)[i] +
+                          p.velocity(2)[i] * p.velocity(2)[i];
+        sum += p.mass()[i] * v2;
+    }
+    return sum / 2;
+}
+
+/**
+ * steps velocity Verlet steps of length dt:
+ *   v += dt / 2 * F / m,  x += dt * v,  F = F(x),  v += dt / 2 * F / m
+ * In a periodic box positions are wrapped back into the box.
+ * Forces are left as of the final positions.
+ */
+template <class Policy = Precise, Functional V>
+requires NVariablesFunctional<1, V>
+NBodyStatus velocity_verlet(const V& v, Particles& particles, double dt, uint64_t steps,
+                            const NBodyOptions& options = {}) {
+    if (const auto status = detail::check(options); status != NBodyStatus::Success) {
+        return status;
+    }
+    const auto kernel = detail::pair_force_kernel(v);
+    // rebuilt every step, its storage is reused
+    detail::CellList cells;
+    const auto forces = [&] {
+        detail::build_cells(cells, particles, options);
+        detail::pair_forces<Policy>(kernel, cells, particles, options);
+    };
+
+    const size_t n = particles.size();
+    auto& pool = utils::default_thread_pool();
+    // blocks of particles for the updates
+    constexpr size_t kBlock = 4096;
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+    const auto kick = [&](size_t block) {
+        const size_t end = std::min(n, (block + 1) * kBlock);
+        for (size_t a = 0; a < 3; ++a) {
+            double* const vel = particles.velocity(a);
+            const double* const f = particles.force(a);
+            const double* const m = particles.mass();
+            for (size_t i = block * kBlock; i < end; ++i) {
+                vel[i] += 0.5 * dt * f[i] / m[i];
+            }
+        }
+    };
+    const auto drift = [&](size_t block) {
+        const size_t end = std::min(n, (block + 1) * kBlock);
+        for (size_t a = 0; a < 3; ++a) {
+            double* const x = particles.position(a);
+            const double* const vel = particles.velocity(a);
+            for (size_t i = block * kBlock; i < end; ++i) {
+                x[i] += dt * vel[i];
+            }
+            if (options.box > 0) {
+                for (size_t i = block * kBlock; i < end; ++i) {
+                    x[i] = detail::wrap(x[i], options.box);
+                }
+            }
+        }
+    };
+
+    forces();
+    for (uint64_t step = 0; step < steps; ++step) {
+        pool.parallel_for(blocks, kick, 1);
+        pool.parallel_for(blocks, drift, 1);
+        forces();
+        pool.parallel_for(blocks, kick, 1);
+    }
+    return NBodyStatus::Success;
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/linalg.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Integration of ordinary differential equations
+ *
+ *   dy_i/dt = f_i(t, y_0, ..., y_{N-1}),  i < N
+ *
+ * with every f_i a Functional of Variable<0> = t and
+ * Variable<1 + j> = y_j, collected by ode_system(f_0, ..., f_{N-1}).
+ *
+ * rk4             classic Runge-Kutta with a fixed number of steps
+ * dormand_prince  adaptive explicit Runge-Kutta 5(4)
+ * rosenbrock      adaptive linearly implicit 2(3) method for stiff systems
+ *                 (Shampine's ode23s), Jacobian built by diff
+ *
+ * The right hand side is evaluated by one fused kernel computing all f_i
+ * of a point at once. Every method has an overload integrating an
+ * Ensemble of initial conditions in place: explicit methods run lanes
+ * of members side by side (SoA, vectorized with FastMath) and
+ * batches of lanes in parallel, the Rosenbrock method runs members
+ * in parallel.
+ */
+namespace veritacpp::dsl::math {
+
+template <Functional... Fs>
+struct OdeSystem {
+    static constexpr size_t kSize = sizeof...(Fs);
+
+    std::tuple<Fs...> rhs;
+
+    template <uint64_t I>
+    constexpr const auto& f() const { return std::get<I>(rhs); }
+};
+
+template <Functional... Fs>
+requires (NVariablesFunctional<sizeof...(Fs) + 1, Fs> && ...)
+constexpr OdeSystem<Fs...> ode_system(const Fs&... fs) {
+    return { { fs... } };
+}
+
+template <size_t N>
+using OdeState = std::array<double, N>;
+
+struct OdeOptions {
+    double relative_tolerance = 1e-6;
+    double absolute_tolerance = 1e-9;
+    double initial_step = 0; // 0: a fraction of the interval
+    double max_step = std::numeric_limits<double>::infinity();
+    uint64_t max_steps = 1'000'000;
+};
+
+enum class OdeStatus : uint8_t {
+    Success,
+    MaxSteps,    // y is the state at t < t1
+    StepTooSmall // the error could not be controlled, y is the state at t < t1
+};
+
+template <size_t N>
+struct OdeSolution {
+    OdeState<N> y;
+    double t;
+    uint64_t steps;    // accepted
+    uint64_t rejected;
+    OdeStatus status;
+};
+
+/**
+ * States of many members integrated together, stored by component:
+ * component(i) points to y_i of all members, contiguously
+ */
+template <size_t N>
+class Ensemble {
+public:
+    explicit Ensemble(size_t members) : members_{members}, data_(N * members) {}
+
+    size_t size() const { return members_; }
+
+    double* component(size_t i) { return data_.data() + i * members_; }
+    const double* component(size_t i) const { return data_.data() + i * members_; }
+
+    OdeState<N> state(size_t member) const {
+        OdeState<N> y;
+        for (size_t i = 0; i < N; ++i) {
+            y[i] = component(i)[member];
+        }
+        return y;
+    }
+
+    void set_state(size_t member, const OdeState<N>& y) {
+        for (size_t i = 0; i < N; ++i) {
+            component(i)[member] = y[i];
+        }
+    }
+
+private:
+    size_t members_;
+    std::vector<double> data_;
+};
+
+namespace detail {
+
+// members integrated side by side by the explicit methods
+constexpr size_t kOdeLanes = 8;
+
+// y[i][lane]
+template <size_t N, size_t W>
+using OdeLanes = std::array<std::array<double, W>, N>;
+
+/**
+ * Fused right hand side: all components of every lane.
+ * The lane loop is outermost, so loads of y are shared by all f_i.
+ */
+template <class Policy, size_t W, Functional... Fs>
+constexpr void evaluate_rhs(const OdeSystem<Fs...>& system, double t,
+                            const OdeLanes<sizeof...(Fs), W>& y,
+                            OdeLanes<sizeof...(Fs), W>& dy) {
+    constexpr auto indices = std::make_index_sequence<sizeof...(Fs)>{};
+    for (size_t l = 0; l < W; ++l) {
+        [&]<uint64_t... j>(std::integer_sequence<uint64_t, j...>) {
+            [&]<uint64_t... i>(std::integer_sequence<uint64_t, i...>) {
+                ((dy[i][l] = static_cast<double>(
+                    evaluate<Policy>(system.template f<i>(), t, y[j][l]...))), ...);
+            }(indices);
+        }(indices);
+    }
+}
+
+// y + h * sum_s a[s] k[s] over stages with nonzero coefficients
+template <size_t N, size_t W, size_t S>
+constexpr void combine(OdeLanes<N, W>& out, const OdeLanes<N, W>& y, double h,
+                       const std::array<double, S>& a, const std::array<OdeLanes<N, W>, 7>& k) {
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t l = 0; l < W; ++l) {
+            double s = 0;
+            for (size_t j = 0; j < S; ++j) {
+                s += a[j] * k[j][i][l];
+            }
+            out[i][l] = y[i][l] + h * s;
+        }
+    }
+}
+
+template <class Policy, size_t W, class System, size_t N = System::kSize>
+constexpr void rk4_lanes(const System& system, double t0, OdeLanes<N, W>& y,
+                         double t1, uint64_t steps) {
+    const double h = (t1 - t0) / double(steps);
+    std::array<OdeLanes<N, W>, 7> k;
+    OdeLanes<N, W> tmp;
+    for (uint64_t step = 0; step < steps; ++step) {
+        const double t = t0 + h * double(step);
+        evaluate_rhs<Policy>(system, t, y, k[0]);
+        combine(tmp, y, h, std::array{ 0.5 }, k);
+        evaluate_rhs<Policy>(system, t + 0.5 * h, tmp, k[1]);
+        combine(tmp, y, h, std::array{ 0.0, 0.5 }, k);
+        evaluate_rhs<Policy>(system, t + 0.5 * h, tmp, k[2]);
+        combine(tmp, y, h, std::array{ 0.0, 0.0, 1.0 }, k);
+        evaluate_rhs<Policy>(system, t + h, tmp, k[3]);
+        combine(y, y, h, std::array{ 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 }, k);
+    }
+}
+
+// Butcher tableau of Dormand-Prince 5(4), the last stage is the solution
+struct DormandPrinceTableau {
+    static constexpr std::array<double, 7> c = { 0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1 };
+    static constexpr std::array<double, 1> a2 = { 1.0 / 5 };
+    static constexpr std::array<double, 2> a3 = { 3.0 / 40, 9.0 / 40 };
+    static constexpr std::array<double, 3> a4 = { 44.0 / 45, -56.0 / 15, 32.0 / 9 };
+    static constexpr std::array<double, 4> a5 = { 19372.0 / 6561, -25360.0 / 2187,
+                                                  64448.0 / 6561, -212.0 / 729 };
+    static constexpr std::array<double, 5> a6 = { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247,
+                                                  49.0 / 176, -5103.0 / 18656 };
+    static constexpr std::array<double, 6> a7 = { 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192,
+                                                  -2187.0 / 6784, 11.0 / 84 };
+    // difference of the 5th and 4th order solutions
+    static constexpr std::array<double, 7> e = { 71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920,
+                                                 -17253.0 / 339200, 22.0 / 525, -1.0 / 40 };
+};
+
+// scaled RMS norm of err, worst lane
+template <size_t N, size_t W>
+constexpr double error_norm(const OdeLanes<N, W>& err, const OdeLanes<N, W>& y,
+                            const OdeLanes<N, W>& y_new, const OdeOptions& options) {
+    std::array<double, W> sum{};
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t l = 0; l < W; ++l) {
+            const double scale = options.absolute_tolerance + options.relative_tolerance *
+                                 std::max(std::abs(y[i][l]), std::abs(y_new[i][l]));
+            const double e = err[i][l] / scale;
+            sum[l] += e * e;
+        }
+    }
+    double worst = 0;
+    for (size_t l = 0; l < W; ++l) {
+        // NaN compares false: a NaN lane rejects the step
+        worst = sum[l] <= worst ? worst : sum[l];
+    }
+    return std::sqrt(worst / double(N));
+}
+
+constexpr double initial_step(double t0, double t1, const OdeOptions& options) {
+    const double h = options.initial_step > 0 ? options.initial_step : 1e-3 * (t1 - t0);
+    return std::min(h, options.max_step);
+}
+
+/**
+ * New step size from the error of the last one,
+ * err^(-1/order) with a safety factor and bounded growth
+ */
+inline double next_step(double h, double err, double order, bool accepted,
+                        const OdeOptions& options) {
+    const double factor = err == 0 ? 5 : 0.9 * std::pow(err, -1 / order);
+    const double bounded = std::clamp(factor, 0.2, accepted ? 5.0 : 1.0);
+    return std::min(h * bounded, options.max_step);
+}
+
+struct OdeProgress {
+    double t;
+    uint64_t steps = 0;
+    uint64_t rejected = 0;
+    OdeStatus status = OdeStatus::Success;
+};
+
+template <class Policy, size_t W, class System, size_t N = System::kSize>
+OdeProgress dormand_prince_lanes(const System& system, double t0, OdeLanes<N, W>& y,
+                                 double t1, const OdeOptions& options) {
+    using T = DormandPrinceTableau;
+    std::array<OdeLanes<N, W>, 7> k;
+    OdeLanes<N, W> tmp, y_new, err;
+
+    OdeProgress progress{ t0 };
+    double& t = progress.t;
+    double h = initial_step(t0, t1, options);
+    evaluate_rhs<Policy>(system, t, y, k[0]);
+    while (t < t1) {
+        if (progress.steps + progress.rejected >= options.max_steps) {
+            progress.status = OdeStatus::MaxSteps;
+            break;
+        }
+        const bool last = t + h >= t1;
+        if (last) {
+            h = t1 - t;
+        }
+        combine(tmp, y, h, T::a2, k);
+        evaluate_rhs<Policy>(system, t + T::c[1] * h, tmp, k[1]);
+        combine(tmp, y, h, T::a3, k);
+        evaluate_rhs<Policy>(system, t + T::c[2] * h, tmp, k[2]);
+        combine(tmp, y, h, T::a4, k);
+        evaluate_rhs<Policy>(system, t + T::c[3] * h, tmp, k[3]);
+        combine(tmp, y, h, T::a5, k);
+        evaluate_rhs<Policy>(system, t + T::c[4] * h, tmp, k[4]);
+        combine(tmp, y, h, T::a6, k);
+        evaluate_rhs<Policy>(system, t + h, tmp, k[5]);
+        combine(y_new, y, h, T::a7, k);
+        evaluate_rhs<Policy>(system, t + h, y_new, k[6]);
+
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t l = 0; l < W; ++l) {
+                double s = 0;
+                for (size_t j = 0; j < 7; ++j) {
+                    s += T::e[j] * k[j][i][l];
+                }
+                err[i][l] = h * s;
+            }
+        }
+        const double norm = error_norm(err, y, y_new, options);
+        const bool accepted = norm <= 1;
+        if (accepted) {
+            t = last ? t1 : t + h;
+            y = y_new;
+            k[0] = k[6]; // first same as last
+            ++progress.steps;
+        } else {
+            ++progress.rejected;
+        }
+        h = next_step(h, std::isnan(norm) ? 1e10 : norm, 5, accepted, options);
+        if (t < t1 && h <= 1e-14 * std::max(1.0, std::abs(t))) {
+            progress.status = OdeStatus::StepTooSmall;
+            break;
+        }
+    }
+    return progress;
+}
+
+/**
+ * Runs integrate(lanes) over batches of kOdeLanes members on the
+ * thread pool; lanes past the last member repeat it
+ */
+template <size_t N, class Integrate>
+void for_each_lane_batch(Ensemble<N>& ensemble, Integrate integrate) {
+    constexpr size_t W = kOdeLanes;
+    const size_t members = ensemble.size();
+    const size_t batches = (members + W - 1) / W;
+    utils::default_thread_pool().parallel_for(batches, [&](size_t batch) {
+        const size_t first = batch * W;
+        const size_t count = std::min(W, members - first);
+        OdeLanes<N, W> y;
+        for (size_t i = 0; i < N; ++i) {
+            const double* const src = ensemble.component(i) + first;
+            for (size_t l = 0; l < W; ++l) {
+                y[i][l] = src[std::min(l, count - 1)];
+            }
+        }
+        integrate(batch, y);
+        for (size_t i = 0; i < N; ++i) {
+            std::copy_n(y[i].data(), count, ensemble.component(i) + first);
+        }
+    }, 1);
+}
+
+} // namespace detail
+
+
+/**
+ * State at t1 after steps equal RK4 steps from y0 at t0
+ */
+template <class Policy = Precise, Functional... Fs>
+OdeState<sizeof...(Fs)> rk4(const OdeSystem<Fs...>& system, double t0,
+                            const OdeState<sizeof...(Fs)>& y0, double t1, uint64_t steps) {
+    constexpr auto N = sizeof...(Fs);
+    detail::OdeLanes<N, 1> y;
+    for (size_t i = 0; i < N; ++i) {
+        y[i][0] = y0[i];
+    }
+    detail::rk4_lanes<Policy, 1>(system, t0, y, t1, steps);
+    OdeState<N> result;
+    for (size_t i = 0; i < N; ++i) {
+        result[i] = y[i][0];
+    }
+    return result;
+}
+
+// every member of the ensemble advanced from t0 to t1
+template <class Policy = Precise, Functional... Fs>
+void rk4(const OdeSystem<Fs...>& system, double t0, Ensemble<sizeof...(Fs)>& ensemble,
+         double t1, uint64_t steps) {
+    detail::for_each_lane_batch(ensemble, [&](size_t, auto& y) {
+        detail::rk4_lanes<Policy, detail::kOdeLanes>(system, t0, y, t1, steps);
+    });
+}
+
+/**
+ * Adaptive integration from t0 to t1 > t0 keeping the local error of
+ * every component below absolute + relative * |y_i| in the RMS norm
+ */
+template <class Policy = Precise, Functional... Fs>
+OdeSolution<sizeof...(Fs)> dormand_prince(const OdeSystem<Fs...>& system, double t0,
+                                          const OdeState<sizeof...(Fs)>& y0, double t1,
+                                          const OdeOptions& options = {}) {
+    constexpr auto N = sizeof...(Fs);
+    assert(t1 >= t0);
+    detail::OdeLanes<N, 1> y;
+    for (size_t i = 0; i < N; ++i) {
+        y[i][0] = y0[i];
+    }
+    const auto progress = detail::dormand_prince_lanes<Policy, 1>(system, t0, y, t1, options);
+    OdeSolution<N> result{ {}, progress.t, progress.steps, progress.rejected, progress.status };
+    for (size_t i = 0; i < N; ++i) {
+        result.y[i] = y[i][0];
+    }
+    return result;
+}
+
+/**
+ * Ensemble version: lanes of a batch share the step size, chosen for
+ * the worst of them. Returns the status of every member.
+ */
+template <class Policy = Precise, Functional... Fs>
+std::vector<OdeStatus> dormand_prince(const OdeSystem<Fs...>& system, double t0,
+                                      Ensemble<sizeof...(Fs)>& ensemble, double t1,
+                                      const OdeOptions& options = {}) {
+    assert(t1 >= t0);
+    std::vector<OdeStatus> status(ensemble.size());
+    detail::for_each_lane_batch(ensemble, [&](size_t batch, auto& y) {
+        const auto progress =
+            detail::dormand_prince_lanes<Policy, detail::kOdeLanes>(system, t0, y, t1, options);
+        const size_t first = batch * detail::kOdeLanes;
+        const size_t last = std::min(status.size(), first + detail::kOdeLanes);
+        std::fill(status.begin() + first, status.begin() + last, progress.status);
+    });
+    return status;
+}
+
+
+namespace detail {
+
+// J[i][j] = d f_i / d y_j and T[i] = d f_i / dt, see ode_jacobian
+template <class Time, class State>
+struct OdeJacobian {
+    static constexpr size_t N = std::tuple_size_v<Time>;
+
+    Time time;
+    State state;
+
+    template <class Policy>
+    constexpr void evaluate_at(double t, const OdeState<N>& y,
+                               linalg::Matrix<N>& j, linalg::Vector<N>& dt) const {
+        [&]<uint64_t... a>(std::integer_sequence<uint64_t, a...>) {
+            const auto at = [&](const auto& f) {
+                return static_cast<double>(evaluate<Policy>(f, t, y[a]...));
+            };
+            [&]<uint64_t... i>(std::integer_sequence<uint64_t, i...>) {
+                ((dt[i] = at(std::get<i>(time))), ...);
+            }(std::make_index_sequence<N>{});
+            // row major over the flat index m = row * N + column
+            [&]<uint64_t... m>(std::integer_sequence<uint64_t, m...>) {
+                ((j[m / N][m % N] = at(std::get<m % N>(std::get<m / N>(state)))), ...);
+            }(std::make_index_sequence<N * N>{});
+        }(std::make_index_sequence<N>{});
+    }
+};
+
+template <Functional... Fs>
+constexpr auto ode_jacobian(const OdeSystem<Fs...>& system) {
+    constexpr auto indices = std::make_index_sequence<sizeof...(Fs)>{};
+    const auto row = [&](const auto& f) {
+        return [&]<uint64_t... j>(std::integer_sequence<uint64_t, j...>) {
+            return std::make_tuple(diff(f, Variable<j + 1>{})...);
+        }(indices);
+    };
+    auto time = std::apply([](const auto&... f) {
+        return std::make_tuple(diff(f, Variable<0>{})...);
+    }, system.rhs);
+    auto state = std::apply([&](const auto&... f) {
+        return std::make_tuple(row(f)...);
+    }, system.rhs);
+    return OdeJacobian<decltype(time), decltype(state)>{ time, state };
+}
+
+template <class Policy, class Jacobian, Functional... Fs, size_t N = sizeof...(Fs)>
+OdeProgress rosenbrock_scalar(const OdeSystem<Fs...>& system, const Jacobian& jacobian,
+                              double t0, OdeState<N>& y, double t1, const OdeOptions& options) {
+    // Shampine & Reichelt, The MATLAB ODE suite (1997)
+    const double d = 1 / (2 + std::sqrt(2.0));
+    const double e32 = 6 + std::sqrt(2.0);
+
+    const auto f = [&](double t, const OdeState<N>& x) {
+        OdeLanes<N, 1> in, out;
+        for (size_t i = 0; i < N; ++i) {
+            in[i][0] = x[i];
+        }
+        evaluate_rhs<Policy>(system, t, in, out);
+        OdeState<N> r;
+        for (size_t i = 0; i < N; ++i) {
+            r[i] = out[i][0];
+        }
+        return r;
+    };
+
+    OdeProgress progress{ t0 };
+    double& t = progress.t;
+    double h = initial_step(t0, t1, options);
+    OdeState<N> f0 = f(t, y);
+    linalg::Matrix<N> j;
+    linalg::Vector<N> dt;
+    while (t < t1) {
+        if (progress.steps + progress.rejected >= options.max_steps) {
+            progress.status = OdeStatus::MaxSteps;
+            break;
+        }
+        const bool last = t + h >= t1;
+        if (last) {
+            h = t1 - t;
+        }
+        jacobian.template evaluate_at<Policy>(t, y, j, dt);
+        // W = I - h d J
+        auto w = linalg::identity<N>();
+        for (size_t a = 0; a < N; ++a) {
+            for (size_t b = 0; b < N; ++b) {
+                w[a][b] -= h * d * j[a][b];
+            }
+        }
+        const linalg::LU<N> lu{ w };
+        bool accepted = false;
+        double norm = std::numeric_limits<double>::infinity();
+        if (!lu.singular) {
+            OdeState<N> rhs, tmp;
+            for (size_t i = 0; i < N; ++i) {
+                rhs[i] = f0[i] + h * d * dt[i];
+            }
+            const auto k1 = lu.solve(rhs);
+            for (size_t i = 0; i < N; ++i) {
+                tmp[i] = y[i] + 0.5 * h * k1[i];
+            }
+            const auto f1 = f(t + 0.5 * h, tmp);
+            for (size_t i = 0; i < N; ++i) {
+                rhs[i] = f1[i] - k1[i];
+            }
+            auto k2 = lu.solve(rhs);
+            OdeState<N> y_new;
+            for (size_t i = 0; i < N; ++i) {
+                k2[i] += k1[i];
+                y_new[i] = y[i] + h * k2[i];
+            }
+            const auto f2 = f(t + h, y_new);
+            for (size_t i = 0; i < N; ++i) {
+                rhs[i] = f2[i] - e32 * (k2[i] - f1[i]) - 2 * (k1[i] - f0[i]) + h * d * dt[i];
+            }
+            const auto k3 = lu.solve(rhs);
+
+            OdeLanes<N, 1> err, y_old, y_next;
+            for (size_t i = 0; i < N; ++i) {
+                err[i][0] = h / 6 * (k1[i] - 2 * k2[i] + k3[i]);
+                y_old[i][0] = y[i];
+                y_next[i][0] = y_new[i];
+            }
+            norm = error_norm(err, y_old, y_next, options);
+            accepted = norm <= 1;
+            if (accepted) {
+                t = last ? t1 : t + h;
+                y = y_new;
+                f0 = f2;
+                ++progress.steps;
+            }
+        }
+        if (!accepted) {
+            ++progress.rejected;
+        }
+        h = next_step(h, std::isfinite(norm) ? norm : 1e10, 3, accepted, options);
+        if (t < t1 && h <= 1e-14 * std::max(1.0, std::abs(t))) {
+            progress.status = OdeStatus::StepTooSmall;
+            break;
+        }
+    }
+    return progress;
+}
+
+} // namespace detail
+
+
+/**
+ * Adaptive integration of a stiff system from t0 to t1 > t0,
+ * same error control as dormand_prince
+ */
+template <class Policy = Precise, Functional... Fs>
+OdeSolution<sizeof...(Fs)> rosenbrock(const OdeSystem<Fs...>& system, double t0,
+                                      const OdeState<sizeof...(Fs)>& y0, double t1,
+                                      const OdeOptions& options = {}) {
+    assert(t1 >= t0);
+    const auto jacobian = detail::ode_jacobian(system);
+    auto y = y0;
+    const auto progress = detail::rosenbrock_scalar<Policy>(system, jacobian, t0, y, t1, options);
+    return { y, progress.t, progress.steps, progress.rejected, progress.status };
+}
+
+// ensemble version: members are integrated in parallel, each with its own steps
+template <class Policy = Precise, Functional... Fs>
+std::vector<OdeStatus> rosenbrock(const OdeSystem<Fs...>& system, double t0,
+                                  Ensemble<sizeof...(Fs)>& ensemble, double t1,
+                                  const OdeOptions& options = {}) {
+    assert(t1 >= t0);
+    const auto jacobian = detail::ode_jacobian(system);
+    std::vector<OdeStatus> status(ensemble.size());
+    utils::default_thread_pool().parallel_for(ensemble.size(), [&](size_t member) {
+        auto y = ensemble.state(member);
+        status[member] = detail::rosenbrock_scalar<Policy>(system, jacobian, t0, y, t1, options).status;
+        ensemble.set_state(member, y);
+    });
+    return status;
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Unconstrained minimization with L-BFGS.
+ *
+ * minimize<N>(f, x0, options, coefficients...) minimizes f over its
+ * first N variables. Further variables of f are fixed coefficients of
+ * the problem, given after the options in the order of their indices.
+ * The gradient is built by diff once per call.
+ *
+ * minimize_all<N>(f, starts, options, coefficients...) solves one
+ * problem per element of starts on a thread pool; the k-th problem
+ * takes the k-th element of every coefficient range.
+ *
+ * All iteration state lives in a fixed size LbfgsWorkspace, so
+ * iterations do not allocate.
+ */
+namespace veritacpp::dsl::math {
+
+enum class MinimizeStatus : uint8_t {
+    Converged,
+    MaxIterations,
+    LineSearchFailed // no step along the search direction decreases f enough
+};
+
+struct MinimizeOptions {
+    double gradient_tolerance = 1e-8;  // on max |df/dx_i|
+    double value_tolerance = 1e-15;    // on the decrease of f, relative to max(1, |f|)
+    uint32_t max_iterations = 500;
+    uint32_t max_line_search = 60;
+};
+
+template <size_t N>
+struct Minimum {
+    std::array<double, N> x;
+    double value;
+    uint32_t iterations;
+    MinimizeStatus status;
+};
+
+/**
+ * Partial derivatives of f by the variables 0..N-1
+ */
+template <size_t N, Functional F>
+constexpr auto gradient(const F& f) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return std::make_tuple(diff(f, Variable<idx>{})...);
+    }(std::make_index_sequence<N>{});
+}
+
+/**
+ * Iteration state of L-BFGS for N variables remembering
+ * the last History steps
+ */
+template <size_t N, size_t History = 8>
+struct LbfgsWorkspace {
+    using Vector = std::array<double, N>;
+
+    std::array<Vector, History> s;  // steps x_{k+1} - x_k
+    std::array<Vector, History> y;  // gradient changes g_{k+1} - g_k
+    std::array<double, History> rho; // 1 / (y_k s_k)
+    std::array<double, History> alpha;
+    Vector x, g, direction, trial_x, trial_g;
+    size_t stored = 0;
+    size_t newest = 0;
+};
+
+namespace detail {
+
+template <size_t N>
+constexpr double dot(const std::array<double, N>& a, const std::array<double, N>& b) {
+    double r = 0;
+    for (size_t i = 0; i < N; ++i) {
+        r += a[i] * b[i];
+    }
+    return r;
+}
+
+template <size_t N>
+constexpr double max_abs(const std::array<double, N>& a) {
+    double r = 0;
+    for (size_t i = 0; i < N; ++i) {
+        r = std::max(r, std::abs(a[i]));
+    }
+    return r;
+}
+
+/**
+ * f and its gradient at x, the coefficients bound to the variables after N
+ */
+template <class Policy, size_t N, class F, class Gradient, class... C>
+struct Objective {
+    const F& f;
+    const Gradient& partials;
+    std::tuple<C...> coefficients;
+
+    constexpr double operator()(const std::array<double, N>& x, std::array<double, N>& g) const {
+        const auto at = [&](const auto& h) {
+            return std::apply([&](auto... c) {
+                return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+                    return static_cast<double>(evaluate<Policy>(h, x[idx]..., c...));
+                }(std::make_index_sequence<N>{});
+            }, coefficients);
+        };
+        [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            ((g[idx] = at(std::get<idx>(partials))), ...);
+        }(std::make_index_sequence<N>{});
+        return at(f);
+    }
+};
+
+// d = -H g by the two loop recursion
+template <size_t N, size_t H>
+constexpr void lbfgs_direction(LbfgsWorkspace<N, H>& w) {
+    auto& d = w.direction;
+    for (size_t i = 0; i < N; ++i) {
+        d[i] = -w.g[i];
+    }
+    for (size_t j = 0; j < w.stored; ++j) {
+        const size_t k = (w.newest + H - j) % H;
+        w.alpha[k] = w.rho[k] * dot(w.s[k], d);
+        for (size_t i = 0; i < N; ++i) {
+            d[i] -= w.alpha[k] * w.y[k][i];
+        }
+    }
+    if (w.stored > 0) {
+        // initial Hessian approximation scaled to the newest curvature
+        const size_t k = w.newest;
+        const double gamma = 1 / (w.rho[k] * dot(w.y[k], w.y[k]));
+        for (size_t i = 0; i < N; ++i) {
+            d[i] *= gamma;
+        }
+    }
+    for (size_t j = w.stored; j > 0; --j) {
+        const size_t k = (w.newest + H - (j - 1)) % H;
+        const double beta = w.rho[k] * dot(w.y[k], d);
+        for (size_t i = 0; i < N; ++i) {
+            d[i] += (w.alpha[k] - beta) * w.s[k][i];
+        }
+    }
+}
+
+/**
+ * Step along w.direction satisfying the weak Wolfe conditions,
+ * found by bisection of the bracket of acceptable steps.
+ * Leaves the accepted point in trial_x, trial_g; returns f there
+ * or NaN if no step was found.
+ */
+template <size_t N, size_t H, class Objective>
+constexpr double wolfe_line_search(const Objective& objective, LbfgsWorkspace<N, H>& w,
+                                   double value, double step, uint32_t max_steps) {
+    constexpr double kSufficientDecrease = 1e-4;
+    constexpr double kCurvature = 0.9;
+    const double slope = dot(w.g, w.direction);
+    double lo = 0;
+    double hi = std::numeric_limits<double>::infinity();
+    for (uint32_t i = 0; i < max_steps; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            w.trial_x[j] = w.x[j] + step * w.direction[j];
+        }
+        const double trial = objective(w.trial_x, w.trial_g);
+        if (!(trial <= value + kSufficientDecrease * step * slope)) {
+            hi = step;  // too long, or f is not finite there
+        } else if (dot(w.trial_g, w.direction) < kCurvature * slope) {
+            lo = step;  // too short
+        } else {
+            return trial;
+        }
+        step = std::isinf(hi) ? 2 * lo : 0.5 * (lo + hi);
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+template <size_t N, size_t H, class Objective>
+constexpr Minimum<N> lbfgs(const Objective& objective, const std::array<double, N>& x0,
+                           const MinimizeOptions& options, LbfgsWorkspace<N, H>& w) {
+    w.stored = 0;
+    w.newest = H - 1;
+    w.x = x0;
+    double value = objective(w.x, w.g);
+
+    for (uint32_t iteration = 0; iteration < options.max_iterations; ++iteration) {
+        if (max_abs(w.g) <= options.gradient_tolerance) {
+            return { w.x, value, iteration, MinimizeStatus::Converged };
+        }
+        lbfgs_direction(w);
+        if (!(dot(w.g, w.direction) < 0)) {
+            // lost the descent property: forget the history
+            w.stored = 0;
+            lbfgs_direction(w);
+        }
+        // without history the direction is -g, of arbitrary length
+        const double step = w.stored == 0 ? std::min(1.0, 1 / max_abs(w.g)) : 1.0;
+        const double trial = wolfe_line_search(objective, w, value, step, options.max_line_search);
+        if (std::isnan(trial)) {
+            return { w.x, value, iteration, MinimizeStatus::LineSearchFailed };
+        }
+
+        std::array<double, N> s{};
+        std::array<double, N> y{};
+        for (size_t i = 0; i < N; ++i) {
+            s[i] = w.trial_x[i] - w.x[i];
+            y[i] = w.trial_g[i] - w.g[i];
+        }
+        // Wolfe steps have positive curvature s y, unless it underflows;
+        // a pair without it is dropped, the history is left as it was
+        const double sy = dot(s, y);
+        if (sy > 0) {
+            w.newest = (w.newest + 1) % H;
+            w.s[w.newest] = s;
+            w.y[w.newest] = y;
+            w.rho[w.newest] = 1 / sy;
+            w.stored = std::min(w.stored + 1, H);
+        }
+
+        const double decrease = value - trial;
+        w.x = w.trial_x;
+        w.g = w.trial_g;
+        value = trial;
+        if (decrease <= options.value_tolerance * std::max(1.0, std::abs(value))) {
+            return { w.x, value, iteration + 1, MinimizeStatus::Converged };
+        }
+    }
+    const auto status = max_abs(w.g) <= options.gradient_tolerance
+                      ? MinimizeStatus::Converged : MinimizeStatus::MaxIterations;
+    return { w.x, value, options.max_iterations, status };
+}
+
+} // namespace detail
+
+
+/**
+ * Minimum of f over its variables 0..N-1 starting from x0, with
+ * variables N, N+1, ... set to the coefficients.
+ * The workspace overload reuses caller's storage.
+ */
+template <size_t N, class Policy = Precise, size_t History, Functional F, Arithmetic... C>
+requires NVariablesFunctional<N + sizeof...(C), F>
+constexpr Minimum<N> minimize(const F& f, const std::array<double, N>& x0,
+                              const MinimizeOptions& options,
+                              LbfgsWorkspace<N, History>& workspace, C... coefficients) {
+    const auto partials = gradient<N>(f);
+    const detail::Objective<Policy, N, F, decltype(partials), C...> objective{
+        f, partials, { coefficients... }
+    };
+    return detail::lbfgs(objective, x0, options, workspace);
+}
+
+template <size_t N, class Policy = Precise, Functional F, Arithmetic... C>
+requires NVariablesFunctional<N + sizeof...(C), F>
+constexpr Minimum<N> minimize(const F& f, const std::array<double, N>& x0,
+                              const MinimizeOptions& options = {}, C... coefficients) {
+    LbfgsWorkspace<N> workspace;
+    return minimize<N, Policy>(f, x0, options, workspace, coefficients...);
+}
+
+/**
+ * Independent problems solved concurrently: the k-th one starts from
+ * starts[k] with coefficients taken from the k-th elements of the
+ * coefficient ranges. Each thread reuses a single workspace.
+ */
+template <size_t N, class Policy = Precise, Functional F,
+          std::ranges::random_access_range Starts,
+          std::ranges::random_access_range... Coefficients>
+requires NVariablesFunctional<N + sizeof...(Coefficients), F> &&
+         std::convertible_to<std::ranges::range_value_t<Starts>, std::array<double, N>>
+std::vector<Minimum<N>> minimize_all(const F& f, const Starts& starts,
+                                     const MinimizeOptions& options,
+                                     const Coefficients&... coefficients) {
+    const auto n = std::ranges::size(starts);
+    assert(((std::ranges::size(coefficients) >= n) && ...));
+
+    const auto partials = gradient<N>(f);
+    std::vector<Minimum<N>> result(n);
+    if (n == 0) {
+        return result;
+    }
+    auto& pool = utils::default_thread_pool();
+    // problems are small: one chunk per thread and a workspace per chunk
+    const size_t chunk = (n + pool.size() - 1) / pool.size();
+    pool.parallel_for((n + chunk - 1) / chunk, [&](size_t block) {
+        LbfgsWorkspace<N> workspace;
+        for (size_t k = block * chunk; k < std::min(n, (block + 1) * chunk); ++k) {
+            using Objective = detail::Objective<Policy, N, F, decltype(partials),
+                                                std::ranges::range_value_t<Coefficients>...>;
+            const Objective objective{ f, partials, { std::ranges::begin(coefficients)[k]... } };
+            result[k] = detail::lbfgs(objective, std::ranges::begin(starts)[k], options, workspace);
+        }
+    }, 1);
+    return result;
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+/**
+ * Instrumented evaluation.
+ *
+ * evaluate<Profiled<Policy>>(f, x...) computes the same values as
+ * evaluate<Policy>(f, x...) and in addition records, for every node
+ * it passes through, the number of calls and the time spent into the
+ * profile of the calling thread. Node kinds are identified by their
+ * template name (Add, Sin, App, ...).
+ *
+ * Instrumentation is selected by the policy type only: evaluation with
+ * any other policy contains no trace of it. Timings include the overhead
+ * of the measurement itself, so they are meaningful relative to each other.
+ */
+namespace veritacpp::dsl::math {
+
+template <class Policy = Precise>
+struct Profiled : Policy {};
+
+/**
+ * Measurements of one thread, accumulated until clear()
+ */
+class Profile {
+public:
+    struct NodeStats {
+        uint64_t calls = 0;
+        std::chrono::nanoseconds total{};  // including children
+        std::chrono::nanoseconds self{};   // excluding children
+    };
+
+    const std::map<std::string, NodeStats, std::less<>>& nodes() const {
+        return nodes_;
+    }
+
+    // self time of every stack of nodes, "Outer;...;Inner" -> time
+    const std::map<std::string, std::chrono::nanoseconds, std::less<>>& stacks() const {
+        return stacks_;
+    }
+
+    void clear() {
+        nodes_.clear();
+        stacks_.clear();
+    }
+
+    /**
+     * Collapsed stacks, one "Outer;...;Inner <nanoseconds>" per line:
+     * the input format of flamegraph.pl and compatible viewers
+     */
+    void write_collapsed(std::ostream& out) const {
+        for (const auto& [stack, time] : stacks_) {
+            out << stack << ' ' << time.count() << '\n';
+        }
+    }
+
+    // table of node kinds sorted by self time
+    void write_summary(std::ostream& out) const {
+        std::vector<std::pair<std::string_view, NodeStats>> rows(nodes_.begin(), nodes_.end());
+        std::ranges::sort(rows, std::greater<>{}, [](const auto& row) {
+            return row.second.self;
+        });
+        out << "node\tcalls\ttotal_ns\tself_ns\n";
+        for (const auto& [name, stats] : rows) {
+            out << name << '\t' << stats.calls << '\t' << stats.total.count()
+                << '\t' << stats.self.count() << '\n';
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        Clock::time_point start;
+        std::chrono::nanoseconds children{};
+        size_t stack_length = 0; // of the parent's stack
+        std::string_view name;
+    };
+
+    template <class Policy, class Node>
+    friend struct detail::EvaluationScope;
+
+    void enter(std::string_view name) {
+        frames_.push_back({ {}, {}, stack_.size(), name });
+        if (!stack_.empty()) {
+            stack_ += ';';
+        }
+        stack_ += name;
+        // started last, so the bookkeeping above is not measured
+        frames_.back().start = Clock::now();
+    }
+
+    void leave() {
+        const auto now = Clock::now();
+        const Frame frame = frames_.back();
+        frames_.pop_back();
+
+        const auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start);
+        const auto self = total - frame.children;
+        auto& stats = find(nodes_, frame.name);
+        stats.calls += 1;
+        stats.total += total;
+        stats.self += self;
+        find(stacks_, stack_) += self;
+
+        stack_.resize(frame.stack_length);
+        if (!frames_.empty()) {
+            frames_.back().children += total;
+        }
+    }
+
+    template <class Map>
+    static typename Map::mapped_type& find(Map& map, std::string_view key) {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            it = map.emplace(std::string(key), typename Map::mapped_type{}).first;
+        }
+        return it->second;
+    }
+
+    std::map<std::string, NodeStats, std::less<>> nodes_;
+    std::map<std::string, std::chrono::nanoseconds, std::less<>> stacks_;
+    std::vector<Frame> frames_;
+    std::string stack_;
+};
+
+// profile of the calling thread
+inline Profile& thread_profile() {
+    thread_local Profile profile;
+    return profile;
+}
+
+namespace detail {
+
+// unqualified template name of T, e.g. "Add" for math::Add<Variable<0>, Sin>
+template <class T>
+constexpr std::string_view node_name() {
+    std::string_view name = __PRETTY_FUNCTION__;
+    constexpr std::string_view marker = "T = ";
+    name.remove_prefix(name.find(marker) + marker.size());
+    name = name.substr(0, name.find_first_of("<;]"));
+    return name.substr(name.rfind("::") == name.npos ? 0 : name.rfind("::") + 2);
+}
+
+template <class Policy, class Node>
+struct EvaluationScope<Profiled<Policy>, Node> {
+    EvaluationScope() {
+        thread_profile().enter(node_name<Node>());
+    }
+
+    ~EvaluationScope() {
+        thread_profile().leave();
+    }
+
+    EvaluationScope(const EvaluationScope&) = delete;
+    EvaluationScope& operator = (const EvaluationScope&) = delete;
+};
+
+} // namespace detail
+
+} // veritacpp::dsl::math
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Numerical integration of Functionals.
+ *
+ * integrate(f, x, a, b, tolerance, coefficients...) integrates f over
+ * the variable x from a to b with globally adaptive Gauss-Kronrod 7-15
+ * quadrature: the panel with the largest error estimate is bisected
+ * until the total estimate is below tolerance * max(1, |integral|).
+ * The other variables of f are set to the coefficients in increasing
+ * order of their indices.
+ *
+ *   // integral of exp(-a t^2) over [0, 1] for a = 2
+ *   auto q = integrate(exp(-a * (t^2)), t, 0, 1, 1e-12, 2.0);
+ *
+ * Both halves of a bisected panel are evaluated as one batch of nodes
+ * by a single loop, which vectorizes with FastMath.
+ *
+ * integrate_nd<N>(f, lower, upper, options, coefficients...) integrates
+ * over a box of the first N variables by randomized quasi-Monte Carlo:
+ * several randomly shifted copies of a Kronecker (R_d) lattice, folded
+ * by the tent transform, whose spread estimates the error. Points are
+ * doubled until the estimate meets the tolerance. Blocks of points are
+ * evaluated on the thread pool (options.pool, by default
+ * utils::default_thread_pool()) into per block sums that are reduced in
+ * a fixed order, so the result does not depend on the number of threads.
+ */
+namespace veritacpp::dsl::math {
+
+enum class QuadratureStatus : uint8_t {
+    Converged,
+    MaxEvaluations, // the error estimate stayed above the tolerance
+    NotFinite       // f was not finite at some point
+};
+
+struct Quadrature {
+    double value;
+    double error;        // estimate of |value - integral|
+    uint64_t evaluations;
+    QuadratureStatus status;
+};
+
+struct IntegrateOptions {
+    double tolerance = 1e-10;          // on the error, relative to max(1, |value|)
+    uint32_t max_panels = 2000;
+};
+
+struct IntegrateNdOptions {
+    double tolerance = 1e-4;           // on the error, relative to max(1, |value|)
+    uint64_t initial_points = 1 << 12; // per shift
+    uint64_t max_points = 1 << 22;     // per shift
+    uint32_t shifts = 8;
+    utils::ThreadPool* pool = nullptr; // nullptr: the default pool
+};
+
+namespace detail {
+
+// Gauss-Kronrod 7-15 on [-1, 1], nodes of the positive half, QUADPACK qk15
+struct GaussKronrod15 {
+    static constexpr std::array<double, 8> node = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.0
+    };
+    static constexpr std::array<double, 8> kronrod = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+    };
+    // weights of the Gauss nodes node[1], node[3], node[5], node[7]
+    static constexpr std::array<double, 4> gauss = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+    };
+    static constexpr size_t kNodes = 15;
+};
+
+struct Panel {
+    double a, b;
+    double value;
+    double error;
+
+    // max heap by error
+    friend constexpr bool operator < (const Panel& l, const Panel& r) {
+        return l.error < r.error;
+    }
+};
+
+/**
+ * Integral and error estimate of a panel from f at its nodes:
+ * f[0..6] left of the center, f[7] at the center, f[8..14] right
+ * of it, mirrored so that f[j] and f[14 - j] share node[j]
+ */
+inline Panel gauss_kronrod_panel(double a, double b, const double* f) {
+    using GK = GaussKronrod15;
+    const double half = 0.5 * (b - a);
+    double kronrod = GK::kronrod[7] * f[7];
+    double gauss = GK::gauss[3] * f[7];
+    for (size_t j = 0; j < 7; ++j) {
+        const double pair = f[j] + f[14 - j];
+        kronrod += GK::kronrod[j] * pair;
+        if (j % 2 == 1) {
+            gauss += GK::gauss[j / 2] * pair;
+        }
+    }
+    // QUADPACK's estimate: |kronrod - gauss| scaled down for smooth integrands
+    const double mean = 0.5 * kronrod;
+    double spread = GK::kronrod[7] * std::abs(f[7] - mean);
+    double magnitude = GK::kronrod[7] * std::abs(f[7]);
+    for (size_t j = 0; j < 7; ++j) {
+        spread += GK::kronrod[j] * (std::abs(f[j] - mean) + std::abs(f[14 - j] - mean));
+        magnitude += GK::kronrod[j] * (std::abs(f[j]) + std::abs(f[14 - j]));
+    }
+    const double scale = std::abs(half);
+    spread *= scale;
+    magnitude *= scale;
+    double error = std::abs((kronrod - gauss) * half);
+    if (spread != 0 && error != 0) {
+        error = spread * std::min(1.0, std::pow(200 * error / spread, 1.5));
+    }
+    constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+    error = std::max(50 * kEpsilon * magnitude, error);
+    return { a, b, kronrod * half, error };
+}
+
+// nodes of the panel [a, b] in the order read by gauss_kronrod_panel
+inline void gauss_kronrod_nodes(double a, double b, double* x) {
+    using GK = GaussKronrod15;
+    const double center = 0.5 * (a + b);
+    const double half = 0.5 * (b - a);
+    for (size_t j = 0; j < 7; ++j) {
+        x[j] = center - half * GK::node[j];
+        x[14 - j] = center + half * GK::node[j];
+    }
+    x[7] = center;
+}
+
+/**
+ * f at every x, the variable I set to x and the other variables
+ * to the coefficients
+ */
+template <class Policy, uint64_t I, class F, size_t M>
+constexpr void evaluate_nodes(const F& f, const double* x, double* out, size_t n,
+                              const std::array<double, M>& c) {
+    [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<double>(
+                evaluate<Policy>(f, (idx == I ? x[i] : c[idx - (idx > I)])...));
+        }
+    }(std::make_index_sequence<M + 1>{});
+}
+
+inline double frac(double v) {
+    return v - std::floor(v);
+}
+
+// uniform in [0, 1) from a counter, splitmix64
+constexpr double hash_uniform(uint64_t v) {
+    v += 0x9e3779b97f4a7c15ull;
+    v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ull;
+    v = (v ^ (v >> 27)) * 0x94d049bb133111ebull;
+    v ^= v >> 31;
+    return double(v >> 11) * 0x1.0p-53;
+}
+
+/**
+ * Generator of the R_d sequence: x_n = frac(shift + n alpha) with
+ * alpha_j = phi^-(j+1), phi the root of phi^(N+1) = phi + 1
+ */
+template <size_t N>
+std::array<double, N> kronecker_alpha() {
+    double phi = 2;
+    for (int i = 0; i < 64; ++i) {
+        phi = std::pow(1 + phi, 1.0 / (N + 1));
+    }
+    std::array<double, N> alpha;
+    double p = 1;
+    for (size_t j = 0; j < N; ++j) {
+        p /= phi;
+        alpha[j] = frac(p);
+    }
+    return alpha;
+}
+
+// points of a block of the nd rule: cache friendly for a few dimensions
+constexpr size_t kCubatureBlock = 256;
+
+} // namespace detail
+
+
+/**
+ * Integral of f over x from a to b, see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Quadrature integrate(const F& f, Variable<I>, double a, double b,
+                     const IntegrateOptions& options, C... coefficients) {
+    using detail::Panel;
+    constexpr auto kNodes = detail::GaussKronrod15::kNodes;
+    const std::array<double, sizeof...(C)> c{ static_cast<double>(coefficients)... };
+    assert(std::isfinite(a) && std::isfinite(b));
+
+    // nodes of two panels evaluated together
+    std::array<double, 2 * kNodes> x, fx;
+    std::vector<Panel> panels;
+    panels.reserve(options.max_panels);
+
+    detail::gauss_kronrod_nodes(a, b, x.data());
+    detail::evaluate_nodes<Policy, I>(f, x.data(), fx.data(), kNodes, c);
+    panels.push_back(detail::gauss_kronrod_panel(a, b, fx.data()));
+    uint64_t evaluations = kNodes;
+
+    const auto totals = [&] {
+        std::pair<double, double> sum{ 0, 0 };
+        for (const auto& p : panels) {
+            sum.first += p.value;
+            sum.second += p.error;
+        }
+        return sum;
+    };
+    auto [value, error] = totals();
+    while (true) {
+        if (!std::isfinite(value) || !std::isfinite(error)) {
+            return { value, error, evaluations, QuadratureStatus::NotFinite };
+        }
+        if (error <= options.tolerance * std::max(1.0, std::abs(value))) {
+            return { value, error, evaluations, QuadratureStatus::Converged };
+        }
+        if (panels.size() >= options.max_panels) {
+            return { value, error, evaluations, QuadratureStatus::MaxEvaluations };
+        }
+        std::pop_heap(panels.begin(), panels.end());
+        const Panel worst = panels.back();
+        panels.pop_back();
+        const double middle = 0.5 * (worst.a + worst.b);
+        detail::gauss_kronrod_nodes(worst.a, middle, x.data());
+        detail::gauss_kronrod_nodes(middle, worst.b, x.data() + kNodes);
+        detail::evaluate_nodes<Policy, I>(f, x.data(), fx.data(), 2 * kNodes, c);
+        evaluations += 2 * kNodes;
+        for (const auto& half : { detail::gauss_kronrod_panel(worst.a, middle, fx.data()),
+                                  detail::gauss_kronrod_panel(middle, worst.b, fx.data() + kNodes) }) {
+            panels.push_back(half);
+            std::push_heap(panels.begin(), panels.end());
+            value += half.value;
+            error += half.error;
+        }
+        value -= worst.value;
+        error -= worst.error;
+        if (panels.size() % 64 == 0) {
+            // running sums drift by cancellation
+            std::tie(value, error) = totals();
+        }
+    }
+}
+
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Quadrature integrate(const F& f, Variable<I> x, double a, double b,
+                     double tolerance, C... coefficients) {
+    return integrate<Policy>(f, x, a, b, IntegrateOptions{ .tolerance = tolerance }, coefficients...);
+}
+
+/**
+ * Integral of f over the box lower <= (x_0..x_{N-1}) <= upper with the
+ * variables N, N+1, ... set to the coefficients, see the top of the file
+ */
+template <size_t N, class Policy = Precise, Functional F, Arithmetic... C>
+requires NVariablesFunctional<N + sizeof...(C), F>
+Quadrature integrate_nd(const F& f, const std::array<double, N>& lower,
+                        const std::array<double, N>& upper,
+                        const IntegrateNdOptions& options = {}, C... coefficients) {
+    constexpr size_t block = detail::kCubatureBlock;
+    const size_t shifts = std::max<uint32_t>(options.shifts, 2);
+    const auto alpha = detail::kronecker_alpha<N>();
+
+    double volume = 1;
+    std::array<double, N> width;
+    for (size_t j = 0; j < N; ++j) {
+        width[j] = upper[j] - lower[j];
+        volume *= width[j];
+    }
+    std::vector<std::array<double, N>> shift_storage(shifts);
+    for (size_t k = 0; k < shifts; ++k) {
+        for (size_t j = 0; j < N; ++j) {
+            shift_storage[k][j] = detail::hash_uniform(k * N + j);
+        }
+    }
+
+    // sum of f over points [first, first + count) of a shifted lattice
+    const auto block_sum = [&](size_t shift, uint64_t first, size_t count) {
+        std::array<std::array<double, block>, N> x;
+        std::array<double, block> fx;
+        for (size_t j = 0; j < N; ++j) {
+            const double s = shift_storage[shift][j];
+            for (size_t i = 0; i < count; ++i) {
+                const double u = detail::frac(s + double(first + i) * alpha[j]);
+                // the tent transform periodizes f: without it the error of
+                // a lattice decays no faster than Monte Carlo's
+                x[j][i] = lower[j] + width[j] * (1 - std::abs(2 * u - 1));
+            }
+        }
+        [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+            for (size_t i = 0; i < count; ++i) {
+                fx[i] = static_cast<double>(evaluate<Policy>(f, x[idx][i]..., coefficients...));
+            }
+        }(std::make_index_sequence<N>{});
+        double sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += fx[i];
+        }
+        return sum;
+    };
+
+    std::vector<double> sums(shifts, 0.0);
+    std::vector<double> partial;
+    uint64_t done = 0;
+    uint64_t target = std::max<uint64_t>(options.initial_points, 1);
+    auto& pool = options.pool ? *options.pool : utils::default_thread_pool();
+    while (true) {
+        // points [done, target) of every shift
+        const uint64_t blocks = (target - done + block - 1) / block;
+        partial.assign(blocks * shifts, 0.0);
+        pool.parallel_for(partial.size(), [&](size_t task) {
+            const size_t shift = task / blocks;
+            const uint64_t first = done + (task % blocks) * block;
+            partial[task] = block_sum(shift, first, std::min<uint64_t>(block, target - first));
+        });
+        for (size_t task = 0; task < partial.size(); ++task) {
+            sums[task / blocks] += partial[task];
+        }
+        done = target;
+
+        double mean = 0;
+        for (const double s : sums) {
+            mean += s;
+        }
+        mean /= double(shifts);
+        double variance = 0;
+        for (const double s : sums) {
+            variance += (s - mean) * (s - mean);
+        }
+        variance /= double(shifts - 1);
+        // standard error of the mean of the shifts
+        const double value = volume * mean / double(done);
+        const double error = std::abs(volume) * std::sqrt(variance / double(shifts)) / double(done);
+        const uint64_t evaluations = done * shifts;
+
+        if (!std::isfinite(value) || !std::isfinite(error)) {
+            return { value, error, evaluations, QuadratureStatus::NotFinite };
+        }
+        if (error <= options.tolerance * std::max(1.0, std::abs(value))) {
+            return { value, error, evaluations, QuadratureStatus::Converged };
+        }
+        if (done >= options.max_points) {
+            return { value, error, evaluations, QuadratureStatus::MaxEvaluations };
+        }
+        target = std::min(2 * done, options.max_points);
+    }
+}
+
+} // veritacpp::dsl::math
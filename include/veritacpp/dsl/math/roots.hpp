@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+/**
+ * Batched root finding.
+ *
+ * solve_roots(f, x, guesses, tolerance, coefficients...) solves
+ * f = 0 for the variable x once per element of guesses. The other
+ * variables of f are coefficients of the equations: the k-th equation
+ * takes the k-th element of every coefficient range, assigned to the
+ * remaining variables in increasing order of their indices.
+ *
+ *   // a x^2 - b = 0 for every (a, b)
+ *   auto roots = solve_roots(a * (x^2) - b, x, guesses, 1e-12, as, bs);
+ *
+ * Derivatives are built by diff once per call. Equations are iterated
+ * in fixed size batches with branchless steps, so with a vectorizable
+ * policy (FastMath) the compiler processes lanes of a batch in SIMD
+ * registers. Converged lanes are masked out and a batch finishes when
+ * all of its lanes do.
+ *
+ * Every lane remembers the last points where f was negative and
+ * positive. Once the root is bracketed by them, steps leaving the
+ * bracket or shrinking too slowly are replaced by bisection, so
+ * bracketed roots are always found.
+ */
+namespace veritacpp::dsl::math {
+
+enum class RootMethod {
+    Newton, // quadratic convergence, uses f'
+    Halley  // cubic convergence, uses f' and f''
+};
+
+enum class RootStatus : uint8_t {
+    Converged,
+    MaxIterations, // the last iterate is returned
+    Failed         // the step became infinite or NaN before a bracket was found
+};
+
+struct RootOptions {
+    double tolerance = 1e-12;   // on the step, relative to max(1, |x|)
+    uint32_t max_iterations = 100;
+    // if both are finite and f changes sign between them, the equation
+    // starts bracketed; iterates never leave [lower, upper]
+    double lower = -std::numeric_limits<double>::infinity();
+    double upper = std::numeric_limits<double>::infinity();
+};
+
+struct Roots {
+    std::vector<double> x;
+    std::vector<RootStatus> status;
+};
+
+namespace detail {
+
+// lanes of a batch: 8 doubles fill an AVX-512 register or two AVX2 ones
+constexpr size_t kRootBatch = 8;
+
+// coefficients of the equations of a batch, one array per variable
+template <size_t M>
+using BatchCoefficients = std::array<std::array<double, kRootBatch>, M>;
+
+/**
+ * Value of f in the i-th lane of a batch: the variable I is set to x,
+ * the other variables to the coefficients of the lane
+ */
+template <class Policy, uint64_t I, class F, size_t M>
+constexpr double evaluate_lane(const F& f, double x, const BatchCoefficients<M>& c, size_t i) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return static_cast<double>(evaluate<Policy>(f, (idx == I ? x : c[idx - (idx > I)][i])...));
+    }(std::make_index_sequence<M + 1>{});
+}
+
+struct RootLanes {
+    std::array<double, kRootBatch> x;
+    std::array<double, kRootBatch> negative; // last point with f < 0, NaN if none yet
+    std::array<double, kRootBatch> positive; // last point with f > 0, NaN if none yet
+    std::array<double, kRootBatch> last_step;
+    // as wide as the doubles: lanes of mixed widths do not vectorize
+    std::array<int64_t, kRootBatch> active;
+    std::array<int64_t, kRootBatch> status;
+};
+
+/**
+ * One step of every active lane given f, f' and f'' at its iterate.
+ * Branchless: all conditions are selects.
+ */
+template <RootMethod Method>
+constexpr void root_step(RootLanes& lanes, const std::array<double, kRootBatch>& f,
+                         const std::array<double, kRootBatch>& d1,
+                         const std::array<double, kRootBatch>& d2,
+                         const RootOptions& options) {
+    // locals do not alias the lanes; & and | instead of && and ||
+    // leave no short circuits, so the loop has no branches
+    const double lower = options.lower;
+    const double upper = options.upper;
+    const double tolerance = options.tolerance;
+    for (size_t i = 0; i < kRootBatch; ++i) {
+        const double x = lanes.x[i];
+        const double negative = f[i] < 0 ? x : lanes.negative[i];
+        const double positive = f[i] > 0 ? x : lanes.positive[i];
+        // the sum is NaN unless both ends are known
+        const double ends = negative + positive;
+        const bool bracketed = ends == ends;
+        const double lo = std::min(negative, positive);
+        const double hi = std::max(negative, positive);
+
+        double step = f[i] / d1[i];
+        if constexpr (Method == RootMethod::Halley) {
+            step = step / (1 - 0.5 * step * d2[i] / d1[i]);
+        }
+        const double candidate = std::clamp(x - step, lower, upper);
+        const bool finite = std::abs(candidate) <= std::numeric_limits<double>::max();
+        const bool inside = (candidate > lo) & (candidate < hi);
+        const bool slow = std::abs(step) > 0.5 * std::abs(lanes.last_step[i]);
+        const bool bisect = bracketed & (!finite | !inside | slow);
+        const double next = bisect ? 0.5 * (lo + hi) : candidate;
+
+        const double scale = std::max(1.0, std::abs(next));
+        const bool root = f[i] == 0;
+        const bool converged = root | (std::abs(next - x) <= tolerance * scale) |
+                               (bracketed & (hi - lo <= tolerance * scale));
+        const bool failed = !finite & !bracketed;
+
+        const bool active = lanes.active[i] != 0;
+        const bool moves = active & !failed & !root;
+        lanes.x[i] = moves ? next : x;
+        lanes.negative[i] = negative;
+        lanes.positive[i] = positive;
+        lanes.last_step[i] = next - x;
+        const auto status = static_cast<int64_t>(failed ? RootStatus::Failed
+                                                 : converged ? RootStatus::Converged
+                                                 : RootStatus::MaxIterations);
+        lanes.status[i] = active ? status : lanes.status[i];
+        lanes.active[i] = active & !failed & !converged;
+    }
+}
+
+} // namespace detail
+
+
+/**
+ * Roots of f(..., x, ...) = 0 starting from every element of guesses,
+ * see the top of the file. Coefficients are contiguous ranges of double
+ * with at least as many elements as guesses.
+ * Policy selects evaluation kernels (evaluate.hpp).
+ */
+template <RootMethod Method = RootMethod::Newton, class Policy = Precise,
+          Functional F, uint64_t I,
+          std::ranges::contiguous_range Guesses,
+          std::ranges::contiguous_range... Coefficients>
+requires NVariablesFunctional<sizeof...(Coefficients) + 1, F> &&
+         (I <= sizeof...(Coefficients))
+Roots solve_roots(const F& f, Variable<I> x, const Guesses& guesses,
+                  const RootOptions& options, const Coefficients&... coefficients) {
+    constexpr auto batch = detail::kRootBatch;
+    const auto n = std::ranges::size(guesses);
+    assert(((std::ranges::size(coefficients) >= n) && ...));
+
+    const auto d1 = diff(f, x);
+    const auto d2 = [&] {
+        if constexpr (Method == RootMethod::Halley) {
+            return diff(d1, x);
+        } else {
+            return kZero;
+        }
+    }();
+
+    Roots roots{ std::vector<double>(n), std::vector<RootStatus>(n) };
+    const auto* const start = std::ranges::data(guesses);
+    const bool bounded = std::isfinite(options.lower) && std::isfinite(options.upper);
+
+    constexpr auto m = sizeof...(Coefficients);
+    const auto coefficient_data = std::array<const double*, m>{ std::ranges::data(coefficients)... };
+    const auto at = [](const auto& g, double v, const auto& c, size_t i) {
+        return detail::evaluate_lane<Policy, I>(g, v, c, i);
+    };
+
+    for (size_t first = 0; first < n; first += batch) {
+        const size_t count = std::min(batch, n - first);
+
+        // lanes past the end repeat the last equation and start inactive
+        detail::RootLanes lanes;
+        detail::BatchCoefficients<m> c;
+        for (size_t i = 0; i < batch; ++i) {
+            const size_t k = first + std::min(i, count - 1);
+            for (size_t j = 0; j < m; ++j) {
+                c[j][i] = coefficient_data[j][k];
+            }
+            lanes.x[i] = std::clamp(static_cast<double>(start[k]), options.lower, options.upper);
+            lanes.negative[i] = lanes.positive[i] = std::numeric_limits<double>::quiet_NaN();
+            lanes.last_step[i] = std::numeric_limits<double>::infinity();
+            lanes.active[i] = i < count;
+            lanes.status[i] = static_cast<int64_t>(RootStatus::MaxIterations);
+        }
+        if (bounded) {
+            for (size_t i = 0; i < batch; ++i) {
+                const double f_lower = at(f, options.lower, c, i);
+                const double f_upper = at(f, options.upper, c, i);
+                if ((f_lower < 0 && f_upper > 0) || (f_lower > 0 && f_upper < 0)) {
+                    lanes.negative[i] = f_lower < 0 ? options.lower : options.upper;
+                    lanes.positive[i] = f_lower < 0 ? options.upper : options.lower;
+                }
+            }
+        }
+
+        std::array<double, batch> fx, d1x, d2x{};
+        for (uint32_t iteration = 0; iteration < options.max_iterations; ++iteration) {
+            for (size_t i = 0; i < batch; ++i) {
+                fx[i] = at(f, lanes.x[i], c, i);
+                d1x[i] = at(d1, lanes.x[i], c, i);
+                if constexpr (Method == RootMethod::Halley) {
+                    d2x[i] = at(d2, lanes.x[i], c, i);
+                }
+            }
+            detail::root_step<Method>(lanes, fx, d1x, d2x, options);
+            if (std::ranges::none_of(lanes.active, std::identity{})) {
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            roots.x[first + i] = lanes.x[i];
+            roots.status[first + i] = static_cast<RootStatus>(lanes.status[i]);
+        }
+    }
+
+    return roots;
+}
+
+template <RootMethod Method = RootMethod::Newton, class Policy = Precise,
+          Functional F, uint64_t I,
+          std::ranges::contiguous_range Guesses,
+          std::ranges::contiguous_range... Coefficients>
+requires NVariablesFunctional<sizeof...(Coefficients) + 1, F> &&
+         (I <= sizeof...(Coefficients))
+Roots solve_roots(const F& f, Variable<I> x, const Guesses& guesses,
+                  double tolerance, const Coefficients&... coefficients) {
+    return solve_roots<Method, Policy>(f, x, guesses, RootOptions{ .tolerance = tolerance },
+                                       coefficients...);
+}
+
+} // veritacpp::dsl::math
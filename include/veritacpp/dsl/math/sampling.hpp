@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+/**
+ * Adaptive sampling of Functionals for plotting.
+ *
+ * adaptive_sample(f, x, a, b, max_error, coefficients...) returns
+ * points of the graph of f over [a, b] such that the polyline through
+ * them stays within about max_error of f (vertically).
+ *
+ * adaptive_mesh(f, x, y, xs, ys, max_error, coefficients...) does the
+ * same for a surface over the rectangle xs by ys, returning a
+ * conforming triangle mesh.
+ *
+ * Both start from a uniform grid and refine in levels. The error of a
+ * segment is estimated from the cubic Hermite interpolant through its
+ * ends, using derivatives built by diff: the cubic differs from the
+ * chord by about length / 4 * max |f'(end) - slope of the chord|.
+ * Segments above the tolerance are bisected, and all new points of a
+ * level are evaluated together as one batch, in blocks spread over
+ * the thread pool. Other variables of f are set to the coefficients
+ * in increasing order of their indices.
+ */
+namespace veritacpp::dsl::math {
+
+struct SampleOptions {
+    uint32_t initial_points = 17; // per side of the initial grid
+    uint32_t max_levels = 30;
+    uint64_t max_points = 1'000'000;
+};
+
+struct Samples {
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+struct Mesh {
+    std::vector<double> x, y, z;
+    // vertex indices, counterclockwise in the (x, y) plane
+    std::vector<std::array<uint32_t, 3>> triangles;
+};
+
+namespace detail {
+
+// points evaluated by one task of a refinement level
+constexpr size_t kSampleBlock = 256;
+
+// deviation of the cubic Hermite interpolant from the chord
+constexpr double hermite_error(double length, double d0, double d1, double rise) {
+    const double slope = rise / length;
+    const double e = std::max(std::abs(d0 - slope), std::abs(d1 - slope));
+    // NaN estimates refine: a pole or a gap may hide there
+    return e == e ? 0.25 * std::abs(length) * e : std::numeric_limits<double>::infinity();
+}
+
+/**
+ * out[i] = f at point i for i in [first, last), with the variables Is
+ * set to the point coordinates and the others to the coefficients
+ */
+template <class Policy, uint64_t... Is, class F, size_t M, size_t D>
+void evaluate_point_range(const F& f, const std::array<const double*, D>& at,
+                          size_t first, size_t last, double* out,
+                          const std::array<double, M>& c) {
+    static constexpr std::array<uint64_t, D> variables{ Is... };
+    // position of the variable idx among the coordinates, D if none
+    constexpr auto slot = [](uint64_t idx) {
+        for (size_t d = 0; d < D; ++d) {
+            if (variables[d] == idx) {
+                return d;
+            }
+        }
+        return D;
+    };
+    // position of the variable idx among the coefficients
+    constexpr auto coefficient = [](uint64_t idx) {
+        size_t k = idx;
+        for (const auto v : variables) {
+            k -= v < idx;
+        }
+        return std::min(k, M == 0 ? 0 : M - 1);
+    };
+    [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        for (size_t i = first; i < last; ++i) {
+            out[i] = static_cast<double>(evaluate<Policy>(f,
+                (slot(idx) < D ? at[std::min(slot(idx), D - 1)][i] : c[coefficient(idx)])...));
+        }
+    }(std::make_index_sequence<M + D>{});
+}
+
+// every function of the tuple fs at n points, in blocks on the thread pool
+template <class Policy, uint64_t... Is, class Fs, size_t M, size_t D>
+void evaluate_points(const Fs& fs, const std::array<const double*, D>& at, size_t n,
+                     const std::array<double*, std::tuple_size_v<Fs>>& out,
+                     const std::array<double, M>& c) {
+    utils::default_thread_pool().parallel_for((n + kSampleBlock - 1) / kSampleBlock, [&](size_t block) {
+        const size_t first = block * kSampleBlock;
+        const size_t last = std::min(n, first + kSampleBlock);
+        [&]<uint64_t... k>(std::integer_sequence<uint64_t, k...>) {
+            (evaluate_point_range<Policy, Is...>(std::get<k>(fs), at, first, last, out[k], c), ...);
+        }(std::make_index_sequence<std::tuple_size_v<Fs>>{});
+    }, 1);
+}
+
+} // namespace detail
+
+
+/**
+ * Graph of f over the variable x on [a, b], see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Samples adaptive_sample(const F& f, Variable<I> x, double a, double b, double max_error,
+                        const SampleOptions& options, C... coefficients) {
+    const std::array<double, sizeof...(C)> c{ static_cast<double>(coefficients)... };
+    const auto fs = std::make_tuple(f, diff(f, x));
+    const size_t n0 = std::max<uint32_t>(options.initial_points, 2);
+    const double min_step = std::abs(b - a) * 1e-12;
+
+    // points in increasing order with f and f' at them
+    std::vector<double> px(n0), pf(n0), pd(n0);
+    for (size_t i = 0; i < n0; ++i) {
+        px[i] = a + (b - a) * double(i) / double(n0 - 1);
+    }
+    detail::evaluate_points<Policy, I>(fs, std::array{ (const double*)px.data() }, n0,
+                                       { pf.data(), pd.data() }, c);
+
+    std::vector<double> mx, mf, md;
+    std::vector<size_t> refined; // left ends of bisected segments
+    std::vector<double> qx, qf, qd;
+    for (uint32_t level = 0; level < options.max_levels; ++level) {
+        refined.clear();
+        mx.clear();
+        for (size_t i = 0; i + 1 < px.size(); ++i) {
+            const double h = px[i + 1] - px[i];
+            const double error = detail::hermite_error(h, pd[i], pd[i + 1], pf[i + 1] - pf[i]);
+            if (error > max_error && std::abs(h) > min_step) {
+                refined.push_back(i);
+                mx.push_back(px[i] + 0.5 * h);
+            }
+        }
+        if (refined.empty() || px.size() + refined.size() > options.max_points) {
+            break;
+        }
+        mf.resize(mx.size());
+        md.resize(mx.size());
+        detail::evaluate_points<Policy, I>(fs, std::array{ (const double*)mx.data() }, mx.size(),
+                                           { mf.data(), md.data() }, c);
+        // merge the midpoints in
+        qx.clear(); qf.clear(); qd.clear();
+        size_t next = 0;
+        for (size_t i = 0; i < px.size(); ++i) {
+            qx.push_back(px[i]); qf.push_back(pf[i]); qd.push_back(pd[i]);
+            if (next < refined.size() && refined[next] == i) {
+                qx.push_back(mx[next]); qf.push_back(mf[next]); qd.push_back(md[next]);
+                ++next;
+            }
+        }
+        std::swap(px, qx);
+        std::swap(pf, qf);
+        std::swap(pd, qd);
+    }
+    return { std::move(px), std::move(pf) };
+}
+
+template <class Policy = Precise, Functional F, uint64_t I, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 1, F> && (I <= sizeof...(C))
+Samples adaptive_sample(const F& f, Variable<I> x, double a, double b, double max_error,
+                        C... coefficients) {
+    return adaptive_sample<Policy>(f, x, a, b, max_error, SampleOptions{}, coefficients...);
+}
+
+/**
+ * Surface of f over the variables x in [xs.first, xs.second] and
+ * y in [ys.first, ys.second], see the top of the file
+ */
+template <class Policy = Precise, Functional F, uint64_t I, uint64_t J, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 2, F> && (I != J) &&
+         (I <= sizeof...(C) + 1) && (J <= sizeof...(C) + 1)
+Mesh adaptive_mesh(const F& f, Variable<I> x, Variable<J> y,
+                   std::pair<double, double> xs, std::pair<double, double> ys, double max_error,
+                   const SampleOptions& options, C... coefficients) {
+    const std::array<double, sizeof...(C)> c{ static_cast<double>(coefficients)... };
+    const auto fs = std::make_tuple(f, diff(f, x), diff(f, y));
+
+    Mesh mesh;
+    std::vector<double> gx, gy;
+    const auto evaluate_new = [&](size_t first) {
+        const size_t n = mesh.x.size();
+        mesh.z.resize(n);
+        gx.resize(n);
+        gy.resize(n);
+        detail::evaluate_points<Policy, I, J>(
+            fs, std::array{ (const double*)mesh.x.data() + first, (const double*)mesh.y.data() + first },
+            n - first, { mesh.z.data() + first, gx.data() + first, gy.data() + first }, c);
+    };
+
+    // uniform grid, every square split along a diagonal
+    const size_t n = std::max<uint32_t>(options.initial_points, 2);
+    for (size_t j = 0; j < n; ++j) {
+        for (size_t i = 0; i < n; ++i) {
+            mesh.x.push_back(xs.first + (xs.second - xs.first) * double(i) / double(n - 1));
+            mesh.y.push_back(ys.first + (ys.second - ys.first) * double(j) / double(n - 1));
+        }
+    }
+    evaluate_new(0);
+    for (uint32_t j = 0; j + 1 < n; ++j) {
+        for (uint32_t i = 0; i + 1 < n; ++i) {
+            const uint32_t v = j * uint32_t(n) + i;
+            const uint32_t right = v + 1, up = v + uint32_t(n), diagonal = up + 1;
+            mesh.triangles.push_back({ v, right, diagonal });
+            mesh.triangles.push_back({ v, diagonal, up });
+        }
+    }
+    // two similar triangles flip orientation when the domain is mirrored
+    const bool mirrored = (xs.second < xs.first) != (ys.second < ys.first);
+    if (mirrored) {
+        for (auto& t : mesh.triangles) {
+            std::swap(t[1], t[2]);
+        }
+    }
+
+    const double min_length = 1e-12 * std::hypot(xs.second - xs.first, ys.second - ys.first);
+    const auto edge_key = [](uint32_t a, uint32_t b) {
+        return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+    };
+    // midpoint vertex of every marked edge of the current level
+    std::unordered_map<uint64_t, uint32_t> midpoints;
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t level = 0; level < options.max_levels; ++level) {
+        midpoints.clear();
+        const size_t first_new = mesh.x.size();
+        for (const auto& t : mesh.triangles) {
+            for (size_t e = 0; e < 3; ++e) {
+                const uint32_t a = t[e], b = t[(e + 1) % 3];
+                const uint64_t key = edge_key(a, b);
+                if (midpoints.contains(key)) {
+                    continue;
+                }
+                const double dx = mesh.x[b] - mesh.x[a];
+                const double dy = mesh.y[b] - mesh.y[a];
+                const double length = std::hypot(dx, dy);
+                // derivatives along the edge
+                const double da = (gx[a] * dx + gy[a] * dy) / length;
+                const double db = (gx[b] * dx + gy[b] * dy) / length;
+                const double error = detail::hermite_error(length, da, db, mesh.z[b] - mesh.z[a]);
+                if (error > max_error && length > min_length) {
+                    midpoints.emplace(key, uint32_t(mesh.x.size()));
+                    mesh.x.push_back(mesh.x[a] + 0.5 * dx);
+                    mesh.y.push_back(mesh.y[a] + 0.5 * dy);
+                }
+            }
+        }
+        if (mesh.x.size() == first_new) {
+            break;
+        }
+        if (mesh.x.size() > options.max_points) {
+            mesh.x.resize(first_new);
+            mesh.y.resize(first_new);
+            break;
+        }
+        evaluate_new(first_new);
+
+        // split every triangle by its marked edges, keeping the orientation
+        triangles.clear();
+        for (const auto& t : mesh.triangles) {
+            std::array<int64_t, 3> m;
+            size_t marked = 0;
+            for (size_t e = 0; e < 3; ++e) {
+                const auto it = midpoints.find(edge_key(t[e], t[(e + 1) % 3]));
+                m[e] = it == midpoints.end() ? -1 : int64_t(it->second);
+                marked += m[e] >= 0;
+            }
+            if (marked == 0) {
+                triangles.push_back(t);
+            } else if (marked == 3) {
+                const uint32_t ab = uint32_t(m[0]), bc = uint32_t(m[1]), ca = uint32_t(m[2]);
+                triangles.push_back({ t[0], ab, ca });
+                triangles.push_back({ ab, t[1], bc });
+                triangles.push_back({ ca, bc, t[2] });
+                triangles.push_back({ ab, bc, ca });
+            } else {
+                // rotate so that edge 0 (a, b) is marked and, with two marks, edge 2 is not
+                size_t r = 0;
+                while (!(m[r] >= 0 && (marked == 1 || m[(r + 2) % 3] < 0))) {
+                    ++r;
+                }
+                const uint32_t a = t[r], b = t[(r + 1) % 3], c2 = t[(r + 2) % 3];
+                const uint32_t ab = uint32_t(m[r]);
+                if (marked == 1) {
+                    triangles.push_back({ a, ab, c2 });
+                    triangles.push_back({ ab, b, c2 });
+                } else {
+                    const uint32_t bc = uint32_t(m[(r + 1) % 3]);
+                    triangles.push_back({ a, ab, c2 });
+                    triangles.push_back({ ab, b, bc });
+                    triangles.push_back({ ab, bc, c2 });
+                }
+            }
+        }
+        std::swap(mesh.triangles, triangles);
+    }
+    return mesh;
+}
+
+template <class Policy = Precise, Functional F, uint64_t I, uint64_t J, Arithmetic... C>
+requires NVariablesFunctional<sizeof...(C) + 2, F> && (I != J) &&
+         (I <= sizeof...(C) + 1) && (J <= sizeof...(C) + 1)
+Mesh adaptive_mesh(const F& f, Variable<I> x, Variable<J> y,
+                   std::pair<double, double> xs, std::pair<double, double> ys, double max_error,
+                   C... coefficients) {
+    return adaptive_mesh<Policy>(f, x, y, xs, ys, max_error, SampleOptions{}, coefficients...);
+}
+
+} // veritacpp::dsl::math
@@ -0,0 +1,784 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+
+#include <veritacpp/utils/mapped_file.hpp>
+
+/**
+ * Binary images of Functionals.
+ *
+ * serialize(f) flattens an expression into a self-contained image:
+ * a header, postfix bytecode and a table of constants. ExpressionImage
+ * evaluates an image in place, without a deserialization step, so an
+ * image saved once by write_image(path, f) can be mapped read-only by
+ * any number of processes with MappedExpression, sharing its pages.
+ *
+ * Variable<I> reads argument I. Applications f | (g0, g1, ...) evaluate
+ * the gs once into local registers, which f reads in place of its
+ * leading variables. Constants of any arithmetic type are stored as
+ * doubles: images always evaluate in double precision.
+ *
+ * There are no parameter slots: RTConstant values are baked into the
+ * constant table, and changing one means writing a new image. Values
+ * that change between evaluations should be variables of the
+ * expression, passed as arguments like the leading parameters of fit:
+ *
+ *   // a exp(b t): one image for all a, b
+ *   auto bytes = serialize(a * exp(b * t));  // a, b, t = Variable<0..2>
+ *   ExpressionImage{ bytes }(2.0, -0.5, t0);
+ *
+ * The format is versioned and in native byte order. An image is checked
+ * once, when it is opened: foreign magic, version or byte order,
+ * truncation and out of range operands give an ImageStatus, and the
+ * interpreter itself runs without checks. It makes one pass over the
+ * bytecode per block of points to amortize dispatch.
+ *
+ * Layout, all fields aligned to 8 bytes:
+ *   ImageHeader                           32 bytes
+ *   ImageInstruction[code_size]           8 bytes each
+ *   double[constant_count]
+ */
+namespace veritacpp::dsl::math {
+
+enum class ImageStatus : uint8_t {
+    Ok,
+    IoError,
+    BadMagic,
+    UnsupportedVersion,
+    ForeignByteOrder,
+    Truncated,
+    Malformed,      // operands out of range, unbalanced stack, register read before
+                    // it is stored, misaligned data
+    TooComplex      // needs more stack or registers than the interpreter has
+};
+
+inline constexpr uint16_t kImageVersion = 1;
+
+namespace detail {
+
+inline constexpr std::array<char, 4> kImageMagic = { 'V', 'C', 'P', 'X' };
+
+// reads as 0x0201 on the other byte order
+inline constexpr uint16_t kImageByteOrder = 0x0102;
+
+inline constexpr uint32_t kImageMaxStack = 64;
+inline constexpr uint32_t kImageMaxLocals = 64;
+
+// points per pass of the interpreter
+inline constexpr size_t kImageLanes = 16;
+
+enum class ImageOp : uint32_t {
+    Constant,   // push constants[arg]
+    Input,      // push argument arg
+    Local,      // push register arg
+    Store,      // pop into register arg
+    Negate,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    PowInt,     // arg is the exponent, an int32
+    Pow,        // exponent is constants[arg]
+    Sin,
+    Cos,
+    Exp,
+    Log,
+    Abs,
+    Sign,
+    Min,
+    Max,
+    Clamp,      // value, lo, hi
+    Select,     // cond, f, g
+    Count
+};
+
+struct ImageInstruction {
+    ImageOp op;
+    uint32_t arg;
+};
+
+struct ImageHeader {
+    std::array<char, 4> magic;
+    uint16_t version;
+    uint16_t byte_order;
+    uint32_t variables;
+    uint32_t locals;
+    uint32_t stack_depth;
+    uint32_t code_size;
+    uint32_t constant_count;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ImageHeader) == 32 && sizeof(ImageInstruction) == 8);
+
+// operands taken from and results left on the stack
+struct StackEffect {
+    uint32_t pops;
+    uint32_t pushes;
+};
+
+constexpr StackEffect stack_effect(ImageOp op) {
+    switch (op) {
+    case ImageOp::Constant:
+    case ImageOp::Input:
+    case ImageOp::Local:
+        return { 0, 1 };
+    case ImageOp::Store:
+        return { 1, 0 };
+    case ImageOp::Add:
+    case ImageOp::Sub:
+    case ImageOp::Mul:
+    case ImageOp::Div:
+    case ImageOp::Min:
+    case ImageOp::Max:
+        return { 2, 1 };
+    case ImageOp::Clamp:
+    case ImageOp::Select:
+        return { 3, 1 };
+    default:
+        return { 1, 1 };
+    }
+}
+
+/**
+ * Accumulates the bytecode of an expression.
+ * Variables are resolved through an environment: entry I is the
+ * instruction that loads variable I, and variables past its end are
+ * arguments of the image.
+ */
+class ImageBuilder {
+public:
+    using Environment = std::vector<ImageInstruction>;
+
+    void emit(ImageOp op, uint32_t arg = 0) {
+        const auto effect = stack_effect(op);
+        assert(depth_ >= effect.pops);
+        depth_ = depth_ - effect.pops + effect.pushes;
+        max_depth_ = std::max(max_depth_, depth_);
+        code_.push_back({ op, arg });
+    }
+
+    void emit_variable(const Environment& env, uint64_t id) {
+        if (id < env.size()) {
+            emit(env[id].op, env[id].arg);
+        } else {
+            variables_ = std::max(variables_, uint32_t(id + 1));
+            emit(ImageOp::Input, uint32_t(id));
+        }
+    }
+
+    uint32_t constant(double c) {
+        for (size_t i = 0; i < constants_.size(); ++i) {
+            if (std::memcmp(&constants_[i], &c, sizeof c) == 0) {
+                return uint32_t(i);
+            }
+        }
+        constants_.push_back(c);
+        return uint32_t(constants_.size() - 1);
+    }
+
+    // registers are released in stack order: see locals() and release()
+    uint32_t allocate_local() {
+        max_locals_ = std::max(max_locals_, locals_ + 1);
+        return locals_++;
+    }
+
+    uint32_t locals() const {
+        return locals_;
+    }
+
+    void release(uint32_t mark) {
+        locals_ = mark;
+    }
+
+    std::vector<std::byte> finish() const {
+        assert(depth_ == 1);
+        ImageHeader header{};
+        header.magic = kImageMagic;
+        header.version = kImageVersion;
+        header.byte_order = kImageByteOrder;
+        header.variables = variables_;
+        header.locals = max_locals_;
+        header.stack_depth = max_depth_;
+        header.code_size = uint32_t(code_.size());
+        header.constant_count = uint32_t(constants_.size());
+
+        const size_t code_bytes = code_.size() * sizeof(ImageInstruction);
+        const size_t constant_bytes = constants_.size() * sizeof(double);
+        std::vector<std::byte> image(sizeof header + code_bytes + constant_bytes);
+        std::memcpy(image.data(), &header, sizeof header);
+        std::memcpy(image.data() + sizeof header, code_.data(), code_bytes);
+        std::memcpy(image.data() + sizeof header + code_bytes, constants_.data(), constant_bytes);
+        return image;
+    }
+
+private:
+    std::vector<ImageInstruction> code_;
+    std::vector<double> constants_;
+    uint32_t depth_ = 0;
+    uint32_t max_depth_ = 0;
+    uint32_t locals_ = 0;
+    uint32_t max_locals_ = 0;
+    uint32_t variables_ = 0;
+};
+
+using ImageEnvironment = ImageBuilder::Environment;
+
+} // namespace detail
+
+
+// bytecode of each node, found by argument dependent lookup like enclose
+
+// any other functional has no bytecode
+template <Functional F>
+void emit_image(detail::ImageBuilder&, const F&, const detail::ImageEnvironment&) {
+    static_assert(sizeof(F) == 0, "no binary image for this node");
+}
+
+template <uint64_t N>
+void emit_image(detail::ImageBuilder& b, Variable<N>, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, N);
+}
+
+template <Arithmetic auto C>
+void emit_image(detail::ImageBuilder& b, Constant<C>, const detail::ImageEnvironment&) {
+    b.emit(detail::ImageOp::Constant, b.constant(double(C)));
+}
+
+template <Arithmetic T>
+void emit_image(detail::ImageBuilder& b, const RTConstant<T>& c, const detail::ImageEnvironment&) {
+    b.emit(detail::ImageOp::Constant, b.constant(double(c.value)));
+}
+
+template <Functional F>
+void emit_image(detail::ImageBuilder& b, const Negate<F>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f(), env);
+    b.emit(detail::ImageOp::Negate);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Add<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Add);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Sub<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Sub);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Mul<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Mul);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Div<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Div);
+}
+
+namespace detail {
+
+/**
+ * Terms [Begin, End) of an n-ary node combined by op in the tree of
+ * pairwise_reduce: the first power of two of them, then the rest,
+ * so that images round as the node evaluates
+ */
+template <uint64_t Begin, uint64_t End, class Node>
+void emit_pairwise(ImageBuilder& b, const Node& f, const ImageEnvironment& env, ImageOp op) {
+    if constexpr (End - Begin == 1) {
+        emit_image(b, f.template term<Begin>(), env);
+    } else {
+        constexpr uint64_t half = std::bit_floor(End - Begin - 1);
+        emit_pairwise<Begin, Begin + half>(b, f, env, op);
+        emit_pairwise<Begin + half, End>(b, f, env, op);
+        b.emit(op);
+    }
+}
+
+} // namespace detail
+
+template <Functional... Fs>
+void emit_image(detail::ImageBuilder& b, const Sum<Fs...>& f, const detail::ImageEnvironment& env) {
+    detail::emit_pairwise<0, sizeof...(Fs)>(b, f, env, detail::ImageOp::Add);
+}
+
+template <Functional... Fs>
+void emit_image(detail::ImageBuilder& b, const Product<Fs...>& f, const detail::ImageEnvironment& env) {
+    detail::emit_pairwise<0, sizeof...(Fs)>(b, f, env, detail::ImageOp::Mul);
+}
+
+template <Functional F, Functional... Gs>
+void emit_image(detail::ImageBuilder& b, const App<F, Gs...>& f, const detail::ImageEnvironment& env) {
+    const auto mark = b.locals();
+    detail::ImageEnvironment inner(std::max(sizeof...(Gs), env.size()));
+    [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        ((emit_image(b, f.template g<idx>(), env),
+          inner[idx] = { detail::ImageOp::Local, b.allocate_local() },
+          b.emit(detail::ImageOp::Store, inner[idx].arg)), ...);
+    }(std::make_index_sequence<sizeof...(Gs)>{});
+    // variables past the gs pass through
+    std::copy(env.begin() + std::min(sizeof...(Gs), env.size()), env.end(),
+              inner.begin() + sizeof...(Gs));
+    emit_image(b, f.f(), inner);
+    b.release(mark);
+}
+
+// elementary functions apply to their first variable
+
+template <Arithmetic auto C>
+void emit_image(detail::ImageBuilder& b, Pow<C>, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    if constexpr (std::is_integral_v<decltype(C)>) {
+        static_assert(C >= INT32_MIN && C <= INT32_MAX, "exponent out of range");
+        b.emit(detail::ImageOp::PowInt, std::bit_cast<uint32_t>(int32_t(C)));
+    } else {
+        b.emit(detail::ImageOp::Pow, b.constant(double(C)));
+    }
+}
+
+template <Arithmetic T>
+void emit_image(detail::ImageBuilder& b, const RTPow<T>& p, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Pow, b.constant(double(p.deg())));
+}
+
+inline void emit_image(detail::ImageBuilder& b, Sin, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Sin);
+}
+
+inline void emit_image(detail::ImageBuilder& b, Cos, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Cos);
+}
+
+inline void emit_image(detail::ImageBuilder& b, Exp, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Exp);
+}
+
+inline void emit_image(detail::ImageBuilder& b, Log, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Log);
+}
+
+inline void emit_image(detail::ImageBuilder& b, Abs, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Abs);
+}
+
+inline void emit_image(detail::ImageBuilder& b, Sign, const detail::ImageEnvironment& env) {
+    b.emit_variable(env, 0);
+    b.emit(detail::ImageOp::Sign);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Min<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Min);
+}
+
+template <Functional F1, Functional F2>
+void emit_image(detail::ImageBuilder& b, const Max<F1, F2>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f1(), env);
+    emit_image(b, f.f2(), env);
+    b.emit(detail::ImageOp::Max);
+}
+
+template <Functional F, Functional Lo, Functional Hi>
+void emit_image(detail::ImageBuilder& b, const Clamp<F, Lo, Hi>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.f(), env);
+    emit_image(b, f.lo(), env);
+    emit_image(b, f.hi(), env);
+    b.emit(detail::ImageOp::Clamp);
+}
+
+template <Functional Cond, Functional F, Functional G>
+void emit_image(detail::ImageBuilder& b, const Select<Cond, F, G>& f, const detail::ImageEnvironment& env) {
+    emit_image(b, f.cond(), env);
+    emit_image(b, f.f(), env);
+    emit_image(b, f.g(), env);
+    b.emit(detail::ImageOp::Select);
+}
+
+namespace detail {
+
+template <size_t W, class Op>
+inline void lanewise(double* a, const double* b, Op op) {
+    for (size_t l = 0; l < W; ++l) {
+        a[l] = op(a[l], b[l]);
+    }
+}
+
+template <size_t W, class Op>
+inline void lanewise(double* a, Op op) {
+    for (size_t l = 0; l < W; ++l) {
+        a[l] = op(a[l]);
+    }
+}
+
+inline double pow_int(double x, int32_t n) {
+    double result = 1;
+    double base = x;
+    for (uint32_t e = n < 0 ? 0u - uint32_t(n) : uint32_t(n); e; e >>= 1) {
+        if (e & 1) {
+            result *= base;
+        }
+        base *= base;
+    }
+    return n < 0 ? 1 / result : result;
+}
+
+} // namespace detail
+
+/**
+ * Image of f. Its arguments are the variables up to the largest
+ * Variable<I> of f that is not bound by an application.
+ */
+template <Functional F>
+std::vector<std::byte> serialize(const F& f) {
+    detail::ImageBuilder builder;
+    emit_image(builder, f, {});
+    return builder.finish();
+}
+
+/**
+ * Evaluates an image in place. Holds no copy of it: the bytes should
+ * outlive the ExpressionImage, and be aligned to 8 bytes (mappings
+ * and vectors are).
+ */
+class ExpressionImage {
+public:
+    ExpressionImage() = default;
+
+    explicit ExpressionImage(std::span<const std::byte> bytes) {
+        status_ = open(bytes);
+    }
+
+    ImageStatus status() const {
+        return status_;
+    }
+
+    bool valid() const {
+        return status_ == ImageStatus::Ok;
+    }
+
+    // number of arguments
+    uint32_t variables() const {
+        return variables_;
+    }
+
+    template <Arithmetic... X>
+    double operator()(X... x) const {
+        const std::array<double, sizeof...(X)> args{ double(x)... };
+        return evaluate(args);
+    }
+
+    double evaluate(std::span<const double> x) const {
+        assert(valid() && x.size() >= variables_);
+        std::array<const double*, detail::kImageMaxLocals> columns{};
+        for (size_t i = 0; i < variables_; ++i) {
+            columns[i] = &x[i];
+        }
+        double result;
+        run<1>(columns.data(), 1, &result);
+        return result;
+    }
+
+    /**
+     * out[i] = f(in[0][i], in[1][i], ...) for i in [0, size(out)):
+     * one column per argument, each with at least size(out) elements.
+     */
+    void evaluate_batch(std::span<double> out, std::span<const double* const> in) const {
+        assert(valid() && in.size() >= variables_);
+        constexpr size_t W = detail::kImageLanes;
+        std::vector<const double*> columns(in.begin(), in.end());
+        for (size_t offset = 0; offset < out.size(); offset += W) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                columns[i] = in[i] + offset;
+            }
+            run<W>(columns.data(), std::min(W, out.size() - offset), out.data() + offset);
+        }
+    }
+
+private:
+    ImageStatus open(std::span<const std::byte> bytes) {
+        using namespace detail;
+        if (bytes.size() < sizeof(ImageHeader)) {
+            return ImageStatus::Truncated;
+        }
+        ImageHeader header;
+        std::memcpy(&header, bytes.data(), sizeof header);
+        if (header.magic != kImageMagic) {
+            return ImageStatus::BadMagic;
+        }
+        if (header.byte_order != kImageByteOrder) {
+            return ImageStatus::ForeignByteOrder;
+        }
+        if (header.version != kImageVersion) {
+            return ImageStatus::UnsupportedVersion;
+        }
+        const uint64_t size = sizeof header + uint64_t(header.code_size) * sizeof(ImageInstruction) +
+                              uint64_t(header.constant_count) * sizeof(double);
+        if (bytes.size() < size) {
+            return ImageStatus::Truncated;
+        }
+        if (bytes.size() > size || reinterpret_cast<uintptr_t>(bytes.data()) % alignof(double)) {
+            return ImageStatus::Malformed;
+        }
+        if (header.stack_depth > kImageMaxStack || header.locals > kImageMaxLocals ||
+                header.variables > kImageMaxLocals) {
+            return ImageStatus::TooComplex;
+        }
+
+        code_ = { reinterpret_cast<const ImageInstruction*>(bytes.data() + sizeof header),
+                  header.code_size };
+        constants_ = reinterpret_cast<const double*>(bytes.data() + sizeof header +
+                                                     header.code_size * sizeof(ImageInstruction));
+        variables_ = header.variables;
+
+        // operands in range, registers stored before they are read and
+        // the stack balanced: run() relies on all three
+        uint32_t depth = 0;
+        std::bitset<kImageMaxLocals> stored;
+        for (const auto& in : code_) {
+            if (in.op >= ImageOp::Count) {
+                return ImageStatus::Malformed;
+            }
+            const auto limit = [&] {
+                switch (in.op) {
+                case ImageOp::Constant:
+                case ImageOp::Pow:
+                    return header.constant_count;
+                case ImageOp::Input:
+                    return header.variables;
+                case ImageOp::Local:
+                case ImageOp::Store:
+                    return header.locals;
+                default:
+                    return UINT32_MAX;
+                }
+            }();
+            const auto effect = stack_effect(in.op);
+            if (in.arg >= limit || depth < effect.pops) {
+                return ImageStatus::Malformed;
+            }
+            if (in.op == ImageOp::Store) {
+                stored.set(in.arg);
+            } else if (in.op == ImageOp::Local && !stored.test(in.arg)) {
+                return ImageStatus::Malformed;
+            }
+            depth = depth - effect.pops + effect.pushes;
+            if (depth > header.stack_depth) {
+                return ImageStatus::Malformed;
+            }
+        }
+        if (depth != 1) {
+            return ImageStatus::Malformed;
+        }
+        return ImageStatus::Ok;
+    }
+
+    // n <= W points, argument i of point l at in[i][l]
+    template <size_t W>
+    void run(const double* const* in, size_t n, double* out) const {
+        using namespace detail;
+        alignas(64) double stack[kImageMaxStack][W];
+        alignas(64) double locals[kImageMaxLocals][W];
+        size_t sp = 0;
+        for (const auto& ins : code_) {
+            switch (ins.op) {
+            case ImageOp::Constant: {
+                const double c = constants_[ins.arg];
+                std::ranges::fill(stack[sp++], c);
+                break;
+            }
+            case ImageOp::Input: {
+                auto* s = stack[sp++];
+                std::copy_n(in[ins.arg], n, s);
+                std::fill(s + n, s + W, 0.0);
+                break;
+            }
+            case ImageOp::Local:
+                std::ranges::copy(locals[ins.arg], stack[sp++]);
+                break;
+            case ImageOp::Store:
+                std::ranges::copy(stack[--sp], locals[ins.arg]);
+                break;
+            case ImageOp::Negate:
+                lanewise<W>(stack[sp - 1], [](double a) { return -a; });
+                break;
+            case ImageOp::Add:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return a + b; });
+                break;
+            case ImageOp::Sub:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return a - b; });
+                break;
+            case ImageOp::Mul:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return a * b; });
+                break;
+            case ImageOp::Div:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return a / b; });
+                break;
+            case ImageOp::PowInt: {
+                const auto e = std::bit_cast<int32_t>(ins.arg);
+                lanewise<W>(stack[sp - 1], [e](double a) { return pow_int(a, e); });
+                break;
+            }
+            case ImageOp::Pow: {
+                const double e = constants_[ins.arg];
+                lanewise<W>(stack[sp - 1], [e](double a) { return std::pow(a, e); });
+                break;
+            }
+            case ImageOp::Sin:
+                lanewise<W>(stack[sp - 1], [](double a) { return std::sin(a); });
+                break;
+            case ImageOp::Cos:
+                lanewise<W>(stack[sp - 1], [](double a) { return std::cos(a); });
+                break;
+            case ImageOp::Exp:
+                lanewise<W>(stack[sp - 1], [](double a) { return std::exp(a); });
+                break;
+            case ImageOp::Log:
+                lanewise<W>(stack[sp - 1], [](double a) { return std::log(a); });
+                break;
+            case ImageOp::Abs:
+                lanewise<W>(stack[sp - 1], Abs{});
+                break;
+            case ImageOp::Sign:
+                lanewise<W>(stack[sp - 1], Sign{});
+                break;
+            case ImageOp::Min:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return b < a ? b : a; });
+                break;
+            case ImageOp::Max:
+                --sp;
+                lanewise<W>(stack[sp - 1], stack[sp], [](double a, double b) { return a < b ? b : a; });
+                break;
+            case ImageOp::Clamp: {
+                sp -= 2;
+                auto* v = stack[sp - 1];
+                const auto* lo = stack[sp];
+                const auto* hi = stack[sp + 1];
+                for (size_t l = 0; l < W; ++l) {
+                    v[l] = v[l] < lo[l] ? lo[l] : (hi[l] < v[l] ? hi[l] : v[l]);
+                }
+                break;
+            }
+            case ImageOp::Select: {
+                sp -= 2;
+                auto* c = stack[sp - 1];
+                const auto* a = stack[sp];
+                const auto* b = stack[sp + 1];
+                for (size_t l = 0; l < W; ++l) {
+                    c[l] = c[l] > 0 ? a[l] : b[l];
+                }
+                break;
+            }
+            case ImageOp::Count:
+                break;
+            }
+        }
+        std::copy_n(stack[0], n, out);
+    }
+
+    std::span<const detail::ImageInstruction> code_;
+    const double* constants_ = nullptr;
+    uint32_t variables_ = 0;
+    ImageStatus status_ = ImageStatus::Truncated;
+};
+
+/**
+ * out[i] = f(in[i]...), as evaluate_batch of a Functional.
+ * Each input range should contain at least size(out) elements.
+ */
+template <std::ranges::contiguous_range Out, std::ranges::contiguous_range... In>
+void evaluate_batch(const ExpressionImage& f, Out&& out, const In&... in) {
+    const std::array<const double*, sizeof...(In)> columns{ std::ranges::data(in)... };
+    f.evaluate_batch(std::span<double>(out), columns);
+}
+
+/**
+ * Saves the image of f. The file is written under a temporary name
+ * and renamed into place, so readers never map a partial image.
+ */
+template <Functional F>
+ImageStatus write_image(const std::string& path, const F& f) {
+    const auto image = serialize(f);
+    const auto tmp = path + ".tmp";
+    std::FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) {
+        return ImageStatus::IoError;
+    }
+    const bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    if (std::fclose(file) != 0 || !written || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return ImageStatus::IoError;
+    }
+    return ImageStatus::Ok;
+}
+
+/**
+ * Image file mapped read-only and ready to evaluate.
+ */
+class MappedExpression {
+public:
+    explicit MappedExpression(const std::string& path)
+        : file_{ path.c_str() }, image_{ file_.bytes() } {}
+
+    ImageStatus status() const {
+        return file_.valid() ? image_.status() : ImageStatus::IoError;
+    }
+
+    bool valid() const {
+        return status() == ImageStatus::Ok;
+    }
+
+    const ExpressionImage& image() const {
+        return image_;
+    }
+
+    template <Arithmetic... X>
+    double operator()(X... x) const {
+        return image_(x...);
+    }
+
+private:
+    utils::MappedFile file_;
+    ExpressionImage image_;
+};
+
+} // veritacpp::dsl::math
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <veritacpp/utils/work_stealing_pool.hpp>
+
+/**
+ * Asynchronous point evaluations, batched.
+ *
+ *   EvaluationService service;
+ *   auto f = service.add<2>(sin(x) * y);
+ *   std::future<double> v = service.evaluate(f, 0.5, 2.0);
+ *
+ * Requests for an expression wait in its queue. The request that fills
+ * the queue to max_batch cuts it into a batch; otherwise a dispatcher
+ * thread cuts it once its oldest request has waited max_latency. So
+ * concurrent requests from many threads are evaluated together by one
+ * vectorizable loop, batches hold at most max_batch requests, and no
+ * request waits much longer than max_latency.
+ * Batches run on a WorkStealingPool: a large batch is halved into
+ * tasks down to chunk requests, and idle workers steal the halves.
+ *
+ * The service is thread safe. Expressions can be added at any time and
+ * live as long as the service. The destructor evaluates the requests
+ * still waiting, so every future gets its value.
+ */
+namespace veritacpp::dsl::math {
+
+struct ServiceOptions {
+    size_t threads = 0;                                 // workers, 0: one per core
+    size_t max_batch = 4096;                            // requests cut into a batch at once
+    std::chrono::microseconds max_latency{ 50 };        // wait of the oldest request before its batch is cut
+    size_t chunk = 256;                                 // requests of the smallest task
+};
+
+struct ServiceStats {
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+};
+
+namespace detail {
+
+// requests cut from a queue, arguments row by row
+struct ServiceBatch {
+    std::vector<double> arguments;
+    std::vector<std::promise<double>> results;
+    std::vector<double> values;
+};
+
+// registered expression and its queue of requests
+struct ServiceEntry {
+    size_t arity;
+    // values[i] = f(row i of arguments) for count rows
+    std::function<void(const double* arguments, double* values, size_t count)> kernel;
+
+    std::mutex mutex;
+    std::unique_ptr<ServiceBatch> pending;
+    std::chrono::steady_clock::time_point oldest;
+};
+
+} // namespace detail
+
+// an expression of N variables added to a service
+template <size_t N>
+struct ServiceExpression {
+    detail::ServiceEntry* entry = nullptr;
+};
+
+class EvaluationService {
+public:
+    explicit EvaluationService(const ServiceOptions& options = {})
+        : options_{ options },
+          pool_{ options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()) },
+          dispatcher_{ [this] { dispatch(); } } {}
+
+    ~EvaluationService() {
+        {
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_.notify_one();
+        // the dispatcher flushes every queue before it returns,
+        // and pool_ runs the batches before it is destroyed
+        dispatcher_.join();
+    }
+
+    EvaluationService(const EvaluationService&) = delete;
+    EvaluationService& operator = (const EvaluationService&) = delete;
+
+    /**
+     * Registers f, evaluated with Policy on its first N variables
+     */
+    template <size_t N, class Policy = Precise, Functional F>
+    requires NVariablesFunctional<N, F>
+    ServiceExpression<N> add(const F& f) {
+        auto entry = std::make_unique<detail::ServiceEntry>();
+        entry->arity = N;
+        entry->kernel = [f](const double* arguments, double* values, size_t count) {
+            [&]<size_t... j>(std::index_sequence<j...>) {
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = static_cast<double>(math::evaluate<Policy>(f, arguments[i * N + j]...));
+                }
+            }(std::make_index_sequence<N>{});
+        };
+        ServiceExpression<N> handle{ entry.get() };
+        std::lock_guard lock{ mutex_ };
+        entries_.push_back(std::move(entry));
+        return handle;
+    }
+
+    template <size_t N>
+    std::future<double> evaluate(ServiceExpression<N> e, const std::array<double, N>& x) {
+        auto& entry = *e.entry;
+        std::future<double> result;
+        std::unique_ptr<detail::ServiceBatch> full;
+        bool signal = false;
+        {
+            std::lock_guard lock{ entry.mutex };
+            if (!entry.pending) {
+                entry.pending = std::make_unique<detail::ServiceBatch>();
+                entry.oldest = std::chrono::steady_clock::now();
+                // the dispatcher learns of the new deadline
+                signal = true;
+            }
+            auto& batch = *entry.pending;
+            batch.arguments.insert(batch.arguments.end(), x.begin(), x.end());
+            result = batch.results.emplace_back().get_future();
+            if (batch.results.size() >= options_.max_batch) {
+                full = std::move(entry.pending);
+                signal = false;
+            }
+        }
+        requests_.fetch_add(1, std::memory_order_relaxed);
+        if (full) {
+            run(entry, std::move(full));
+        } else if (signal) {
+            {
+                std::lock_guard lock{ mutex_ };
+                ++signals_;
+            }
+            wake_.notify_one();
+        }
+        return result;
+    }
+
+    template <size_t N, Arithmetic... X>
+    requires (sizeof...(X) == N)
+    std::future<double> evaluate(ServiceExpression<N> e, X... x) {
+        return evaluate(e, std::array<double, N>{ static_cast<double>(x)... });
+    }
+
+    ServiceStats stats() const {
+        return { requests_.load(std::memory_order_relaxed), batches_.load(std::memory_order_relaxed) };
+    }
+
+private:
+    void dispatch() {
+        using Clock = std::chrono::steady_clock;
+        std::unique_lock lock{ mutex_ };
+        uint64_t seen = 0;
+        while (true) {
+            seen = signals_;
+            const bool stopping = stop_;
+            const auto now = Clock::now();
+            auto deadline = Clock::time_point::max();
+            // entries_ only grows under mutex_, which is held here
+            for (const auto& entry : entries_) {
+                std::unique_ptr<detail::ServiceBatch> batch;
+                {
+                    std::lock_guard entry_lock{ entry->mutex };
+                    if (!entry->pending) {
+                        continue;
+                    }
+                    const auto due = entry->oldest + options_.max_latency;
+                    if (stopping || due <= now) {
+                        batch = std::move(entry->pending);
+                    } else {
+                        deadline = std::min(deadline, due);
+                    }
+                }
+                if (batch) {
+                    run(*entry, std::move(batch));
+                }
+            }
+            if (stopping) {
+                // requests made during the flush are not accepted:
+                // the service is being destroyed
+                return;
+            }
+            const auto woken = [&] { return stop_ || signals_ != seen; };
+            if (deadline == Clock::time_point::max()) {
+                wake_.wait(lock, woken);
+            } else {
+                wake_.wait_until(lock, deadline, woken);
+            }
+        }
+    }
+
+    void run(detail::ServiceEntry& entry, std::unique_ptr<detail::ServiceBatch> batch) {
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        const size_t n = batch->results.size();
+        batch->values.resize(n);
+        std::shared_ptr<detail::ServiceBatch> shared = std::move(batch);
+        pool_.submit([this, &entry, shared, n] { run_rows(entry, shared, 0, n); });
+    }
+
+    // rows [begin, end): halves are left to thieves down to chunk rows
+    void run_rows(detail::ServiceEntry& entry, const std::shared_ptr<detail::ServiceBatch>& batch,
+                  size_t begin, size_t end) {
+        const size_t chunk = std::max<size_t>(1, options_.chunk);
+        while (end - begin > chunk) {
+            const size_t middle = begin + (end - begin) / 2;
+            pool_.submit([this, &entry, batch, middle, end] { run_rows(entry, batch, middle, end); });
+            end = middle;
+        }
+        entry.kernel(batch->arguments.data() + begin * entry.arity, batch->values.data() + begin,
+                     end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            batch->results[i].set_value(batch->values[i]);
+        }
+    }
+
+    ServiceOptions options_;
+    std::vector<std::unique_ptr<detail::ServiceEntry>> entries_;
+    std::atomic<uint64_t> requests_{ 0 };
+    std::atomic<uint64_t> batches_{ 0 };
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    uint64_t signals_ = 0;
+    bool stop_ = false;
+    // destroyed before the entries: the batches it still runs use them
+    utils::WorkStealingPool pool_;
+    std::thread dispatcher_;
+};
+
+} // veritacpp::dsl::math
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+
+namespace veritacpp::dsl::math::detail {
+
+/**
+ * Storage of a single child of a composite node.
+ * Stateless children are not stored at all: they are rebuilt on access.
+ * Owner and Idx make every slot type unique, so empty slots
+ * never have to be placed at distinct addresses.
+ */
+template <class Owner, uint64_t Idx, Functional F>
+struct NodeSlot {
+    F value;
+
+    constexpr explicit NodeSlot(F f) : value{f} {}
+
+    constexpr const F& get() const {
+        return value;
+    }
+};
+
+template <class Owner, uint64_t Idx, StatelessFunctional F>
+struct NodeSlot<Owner, Idx, F> {
+    constexpr NodeSlot() = default;
+    constexpr explicit NodeSlot(F) {}
+
+    constexpr F get() const {
+        return F{};
+    }
+};
+
+template <class Owner, class Seq, Functional... Fs>
+struct NodePackImpl;
+
+template <class Owner, uint64_t... idx, Functional... Fs>
+struct NodePackImpl<Owner, std::integer_sequence<uint64_t, idx...>, Fs...>
+    : NodeSlot<Owner, idx, Fs>... {
+
+    constexpr NodePackImpl() = default;
+    constexpr explicit NodePackImpl(Fs... fs) : NodeSlot<Owner, idx, Fs>{fs}... {}
+
+    template <uint64_t I>
+    constexpr decltype(auto) get() const {
+        return slot<I>(*this).get();
+    }
+
+private:
+    // pack indexing by base class deduction: no recursive instantiations
+    template <uint64_t I, class F>
+    static constexpr const NodeSlot<Owner, I, F>& slot(const NodeSlot<Owner, I, F>& s) {
+        return s;
+    }
+};
+
+/**
+ * Compact replacement of std::tuple for children of composite nodes.
+ * Members of this type should be declared [[no_unique_address]]:
+ * a pack of stateless children is empty then, and so is the owner.
+ */
+template <class Owner, Functional... Fs>
+using NodePack = NodePackImpl<Owner, std::make_integer_sequence<uint64_t, sizeof...(Fs)>, Fs...>;
+
+} // veritacpp::dsl::math::detail
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <veritacpp/dsl/math/core_concepts.hpp>
+#include <veritacpp/dsl/math/constants.hpp>
+#include <veritacpp/dsl/math/variable.hpp>
+
+namespace veritacpp::dsl::math {
+
+enum class Interpolation {
+    Linear,
+    Cubic // Hermite spline, slopes from 4th order finite differences
+};
+
+namespace detail {
+
+template <Interpolation I>
+constexpr size_t kTableStride = I == Interpolation::Cubic ? 2 : 1;
+
+template <Interpolation I>
+constexpr size_t kMinTableSize = I == Interpolation::Cubic ? 5 : 2;
+
+/**
+ * Samples f at n uniform points of [lo, hi].
+ * Cubic tables interleave values and slopes, the latter scaled
+ * by the step: y0, h*y0', y1, h*y1', ...
+ */
+template <Interpolation I, class F>
+constexpr void sample_table(const F& f, double lo, double hi, double* table, size_t n) {
+    constexpr auto stride = kTableStride<I>;
+    const double step = (hi - lo) / double(n - 1);
+    for (size_t i = 0; i < n; ++i) {
+        // last point exactly at hi
+        table[i * stride] = f(i + 1 == n ? hi : lo + step * double(i));
+    }
+    if constexpr (I == Interpolation::Cubic) {
+        const auto y = [table](size_t i) { return table[2 * i]; };
+        for (size_t i = 2; i + 2 < n; ++i) {
+            table[2 * i + 1] = (y(i - 2) - 8 * y(i - 1) + 8 * y(i + 1) - y(i + 2)) / 12;
+        }
+        // one-sided differences of the same order near the ends
+        table[1] = (-25 * y(0) + 48 * y(1) - 36 * y(2) + 16 * y(3) - 3 * y(4)) / 12;
+        table[3] = (-3 * y(0) - 10 * y(1) + 18 * y(2) - 6 * y(3) + y(4)) / 12;
+        const size_t l = n - 1;
+        table[2 * l + 1] = (25 * y(l) - 48 * y(l - 1) + 36 * y(l - 2) - 16 * y(l - 3) + 3 * y(l - 4)) / 12;
+        table[2 * l - 1] = (3 * y(l) + 10 * y(l - 1) - 18 * y(l - 2) + 6 * y(l - 3) - y(l - 4)) / 12;
+    }
+}
+
+/**
+ * Order-th derivative of the interpolant at x.
+ * Outside of the table the outermost pieces are extrapolated.
+ */
+template <Interpolation I, unsigned Order>
+constexpr double interpolate(const double* table, size_t n, double lo,
+                             double inv_step, double x) {
+    const double t = (x - lo) * inv_step;
+    // NaN goes to the first cell and stays NaN in u
+    double cell = t > 0 ? t : 0;
+    cell = cell < double(n - 2) ? cell : double(n - 2);
+    const auto i = static_cast<size_t>(cell);
+    const double u = t - double(i);
+
+    double scale = 1;
+    for (unsigned k = 0; k < Order; ++k) {
+        scale *= inv_step;
+    }
+
+    if constexpr (I == Interpolation::Linear) {
+        const double y0 = table[i];
+        const double y1 = table[i + 1];
+        if constexpr (Order == 0) {
+            return y0 + (y1 - y0) * u;
+        } else if constexpr (Order == 1) {
+            return (y1 - y0) * scale;
+        } else {
+            return 0;
+        }
+    } else {
+        const double* p = table + 2 * i;
+        const double y0 = p[0], m0 = p[1], y1 = p[2], m1 = p[3];
+        // c0 + c1 u + c2 u^2 + c3 u^3
+        const double c1 = m0;
+        const double c2 = 3 * (y1 - y0) - 2 * m0 - m1;
+        const double c3 = 2 * (y0 - y1) + m0 + m1;
+        if constexpr (Order == 0) {
+            return ((c3 * u + c2) * u + c1) * u + y0;
+        } else if constexpr (Order == 1) {
+            return ((3 * c3 * u + 2 * c2) * u + c1) * scale;
+        } else if constexpr (Order == 2) {
+            return (6 * c3 * u + 2 * c2) * scale;
+        } else if constexpr (Order == 3) {
+            return 6 * c3 * scale;
+        } else {
+            return 0;
+        }
+    }
+}
+
+template <Interpolation I, unsigned Order>
+constexpr bool kInterpolantVanishes =
+    Order > (I == Interpolation::Cubic ? 3u : 1u);
+
+} // namespace detail
+
+
+/**
+ * Univariate function replaced by interpolation over N samples
+ * on [lo, hi]. The table is part of the node, so a constexpr
+ * Tabulated is sampled at compile time.
+ * Order > 0 evaluates derivatives of the interpolant.
+ */
+template <size_t N, Interpolation I = Interpolation::Cubic, unsigned Order = 0>
+struct Tabulated : FunctionNode<Tabulated<N, I, Order>> {
+    static_assert(N >= detail::kMinTableSize<I>, "too few samples for interpolation");
+
+    static constexpr uint64_t arity = 1;
+
+    std::array<double, N * detail::kTableStride<I>> table{};
+    double lo = 0;
+    double inv_step = 0;
+
+    template <class F>
+    requires NVariablesFunctional<1, F>
+    constexpr Tabulated(const F& f, double lo, double hi)
+        : lo{lo}, inv_step{double(N - 1) / (hi - lo)} {
+        detail::sample_table<I>(f, lo, hi, table.data(), N);
+    }
+
+    template <unsigned Other>
+    constexpr explicit Tabulated(const Tabulated<N, I, Other>& other)
+        : table{other.table}, lo{other.lo}, inv_step{other.inv_step} {}
+
+    template <Arithmetic X, Arithmetic... Xs>
+    constexpr Arithmetic auto operator()(X x, Xs...) const {
+        return detail::interpolate<I, Order>(table.data(), N, lo, inv_step,
+                                             static_cast<double>(x));
+    }
+};
+
+/**
+ * Same as Tabulated with the number of samples chosen at runtime.
+ * The table is shared between copies of the node and its derivatives.
+ */
+template <Interpolation I = Interpolation::Cubic, unsigned Order = 0>
+struct RTTabulated : FunctionNode<RTTabulated<I, Order>> {
+    static constexpr uint64_t arity = 1;
+
+    std::shared_ptr<const std::vector<double>> table;
+    size_t n = 0;
+    double lo = 0;
+    double inv_step = 0;
+
+    template <class F>
+    requires NVariablesFunctional<1, F>
+    RTTabulated(const F& f, double lo, double hi, size_t n)
+        : n{n}, lo{lo}, inv_step{double(n - 1) / (hi - lo)} {
+        assert(n >= detail::kMinTableSize<I> && lo < hi);
+        auto samples = std::vector<double>(n * detail::kTableStride<I>);
+        detail::sample_table<I>(f, lo, hi, samples.data(), n);
+        table = std::make_shared<const std::vector<double>>(std::move(samples));
+    }
+
+    template <unsigned Other>
+    explicit RTTabulated(const RTTabulated<I, Other>& other)
+        : table{other.table}, n{other.n}, lo{other.lo}, inv_step{other.inv_step} {}
+
+    template <Arithmetic X, Arithmetic... Xs>
+    Arithmetic auto operator()(X x, Xs...) const {
+        return detail::interpolate<I, Order>(table->data(), n, lo, inv_step,
+                                             static_cast<double>(x));
+    }
+};
+
+/**
+ * tabulate<N>(f, lo, hi): f of Variable<0> sampled at N points,
+ * at compile time when the result is constexpr.
+ * tabulate(f, lo, hi, n): sampled at construction into shared storage.
+ * Precondition: lo < hi, n >= 5 for cubic and n >= 2 for linear interpolation.
+ */
+template <size_t N, Interpolation I = Interpolation::Cubic, Functional F>
+requires NVariablesFunctional<1, F>
+constexpr Functional auto tabulate(const F& f, double lo, double hi) {
+    return Tabulated<N, I>{ f, lo, hi };
+}
+
+template <Interpolation I = Interpolation::Cubic, Functional F>
+requires NVariablesFunctional<1, F>
+Functional auto tabulate(const F& f, double lo, double hi, size_t n) {
+    return RTTabulated<I>{ f, lo, hi, n };
+}
+
+
+template <size_t N, Interpolation I, unsigned Order, uint64_t xid>
+constexpr Functional auto diff(const Tabulated<N, I, Order>& t, Variable<xid>) {
+    if constexpr (xid != 0 || detail::kInterpolantVanishes<I, Order + 1>) {
+        return kZero;
+    } else {
+        return Tabulated<N, I, Order + 1>{ t };
+    }
+}
+
+template <Interpolation I, unsigned Order, uint64_t xid>
+Functional auto diff(const RTTabulated<I, Order>& t, Variable<xid>) {
+    if constexpr (xid != 0 || detail::kInterpolantVanishes<I, Order + 1>) {
+        return kZero;
+    } else {
+        return RTTabulated<I, Order + 1>{ t };
+    }
+}
+
+} // veritacpp::dsl::math
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <tuple>
 
 #include <veritacpp/dsl/math/core_concepts.hpp>
 #include <veritacpp/dsl/math/constants.hpp>
@@ -52,8 +54,9 @@ VariableBindingGroup(Var...) -> VariableBindingGroup<Var...>;
 
 
 template <uint64_t N>
-struct Variable : BasicFunction {
+struct Variable : FunctionNode<Variable<N>> {
     static constexpr auto Id = N;
+    static constexpr uint64_t arity = N + 1;
 
     constexpr Arithmetic auto operator()(Arithmetic auto... args) const 
     requires (sizeof...(args) > N)
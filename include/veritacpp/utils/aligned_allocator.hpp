@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace veritacpp::utils {
+
+/**
+ * Allocator of storage aligned to Alignment bytes, by default a cache
+ * line: a buffer starts on a line boundary and loops over it begin
+ * with a full vector load.
+ */
+template <class T, size_t Alignment = 64>
+struct AlignedAllocator {
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0);
+
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <class U>
+    constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t{ Alignment });
+    }
+
+    template <class U>
+    constexpr bool operator == (const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+};
+
+template <class T, size_t Alignment = 64>
+using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+} // namespace veritacpp::utils
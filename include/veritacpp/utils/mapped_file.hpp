@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace veritacpp::utils {
+
+/**
+ * Mapping of a whole file.
+ *
+ * Pages are shared with every other process mapping the same file,
+ * and are read in lazily by the kernel. An empty or unreadable file
+ * gives an invalid mapping: valid() is false and bytes() is empty.
+ * create(path, size) makes a writable mapping of a new file of the
+ * given size; writes go to the file through the page cache.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const char* path) {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<std::byte*>(p);
+                size_ = size_t(st.st_size);
+            }
+        }
+        // the mapping keeps the file alive
+        ::close(fd);
+    }
+
+    static MappedFile create(const char* path, size_t size) {
+        MappedFile file;
+        const int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return file;
+        }
+        if (size > 0 && ::ftruncate(fd, off_t(size)) == 0) {
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                file.data_ = static_cast<std::byte*>(p);
+                file.size_ = size;
+                file.writable_ = true;
+            }
+        }
+        ::close(fd);
+        return file;
+    }
+
+    ~MappedFile() {
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_{ std::exchange(other.data_, nullptr) },
+          size_{ std::exchange(other.size_, 0) },
+          writable_{ std::exchange(other.writable_, false) } {}
+
+    MappedFile& operator = (MappedFile&& other) noexcept {
+        MappedFile tmp{ std::move(other) };
+        std::swap(data_, tmp.data_);
+        std::swap(size_, tmp.size_);
+        std::swap(writable_, tmp.writable_);
+        return *this;
+    }
+
+    bool valid() const {
+        return data_ != nullptr;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return { data_, size_ };
+    }
+
+    // empty unless created writable
+    std::span<std::byte> writable_bytes() const {
+        return writable_ ? std::span<std::byte>{ data_, size_ } : std::span<std::byte>{};
+    }
+
+    // starts writing [offset, offset + length) back to the file
+    void flush(size_t offset, size_t length) const {
+        if (writable_ && offset < size_) {
+            const size_t start = page_start(offset);
+            ::msync(data_ + start, std::min(size_, offset + length) - start, MS_ASYNC);
+        }
+    }
+
+    // hint that [offset, offset + length) is read next, in order
+    void will_need(size_t offset, size_t length) const {
+        advise(offset, length, MADV_WILLNEED);
+    }
+
+    // hint that [offset, offset + length) is not used again: its pages
+    // leave the process, and written ones stay in the page cache
+    void dont_need(size_t offset, size_t length) const {
+        advise(offset, length, MADV_DONTNEED);
+    }
+
+    void sequential() const {
+        advise(0, size_, MADV_SEQUENTIAL);
+    }
+
+private:
+    void advise(size_t offset, size_t length, int advice) const {
+        if (!data_ || offset >= size_) {
+            return;
+        }
+        const size_t start = page_start(offset);
+        ::madvise(data_ + start, std::min(size_, offset + length) - start, advice);
+    }
+
+    // madvise and msync want a page aligned start
+    static size_t page_start(size_t offset) {
+        const size_t page = size_t(::sysconf(_SC_PAGESIZE));
+        return offset / page * page;
+    }
+
+    std::byte* data_ = nullptr;
+    size_t size_ = 0;
+    bool writable_ = false;
+};
+
+} // namespace veritacpp::utils
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace veritacpp::utils {
+
+/**
+ * Philox4x32-10 counter based generator (Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", SC 2011).
+ *
+ * There is no state: the output is a bijection of the 128 bit counter
+ * under a 64 bit key, so any element of any stream is computed directly
+ * from its coordinates. Counters of different threads or vector lanes
+ * never overlap and no generator is shared between them.
+ * The rounds are only multiplications and xors, so loops over counters
+ * vectorize.
+ */
+struct Philox4x32 {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+    static constexpr int kRounds = 10;
+
+    static constexpr Counter generate(Counter c, Key k) {
+        for (int round = 0; round < kRounds; ++round) {
+            const uint64_t p0 = uint64_t(kMultiplier0) * c[0];
+            const uint64_t p1 = uint64_t(kMultiplier1) * c[2];
+            c = { uint32_t(p1 >> 32) ^ c[1] ^ k[0], uint32_t(p1),
+                  uint32_t(p0 >> 32) ^ c[3] ^ k[1], uint32_t(p0) };
+            k[0] += kWeyl0;
+            k[1] += kWeyl1;
+        }
+        return c;
+    }
+
+    /**
+     * Two doubles uniform in (0, 1], element (stream, index) of the
+     * streams of seed: 53 random bits each, never 0, so their logarithm
+     * is finite.
+     */
+    static constexpr std::array<double, 2> uniform(uint64_t seed, uint64_t stream, uint64_t index) {
+        const auto r = generate({ uint32_t(index), uint32_t(index >> 32),
+                                  uint32_t(stream), uint32_t(stream >> 32) },
+                                { uint32_t(seed), uint32_t(seed >> 32) });
+        constexpr double kUnit = 1.0 / double(uint64_t(1) << 53);
+        const uint64_t a = (uint64_t(r[0]) << 32 | r[1]) >> 11;
+        const uint64_t b = (uint64_t(r[2]) << 32 | r[3]) >> 11;
+        return { double(a + 1) * kUnit, double(b + 1) * kUnit };
+    }
+};
+
+} // namespace veritacpp::utils
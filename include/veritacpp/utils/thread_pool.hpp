@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace veritacpp::utils {
+
+/**
+ * Fixed set of worker threads running data parallel loops.
+ *
+ * parallel_for(n, f) calls f(i) for every i in [0, n) on the workers
+ * and the calling thread, and returns when all calls are done.
+ * Indices are handed out in chunks from a shared counter, so uneven
+ * work balances itself. Loops started from inside a loop of the same
+ * pool run sequentially on the calling worker; loops from different
+ * threads are serialized.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        // the calling thread is one of the executors
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    // number of threads executing a loop, including the caller
+    size_t size() const {
+        return workers_.size() + 1;
+    }
+
+    /**
+     * f(i) for i in [0, n). The first exception thrown by f is rethrown
+     * here after the loop stops; indices not started by then are skipped.
+     */
+    template <class F>
+    void parallel_for(size_t n, F&& f, size_t chunk = 0) {
+        if (n == 0) {
+            return;
+        }
+        if (chunk == 0) {
+            // a few chunks per thread to balance uneven work
+            chunk = std::max<size_t>(1, n / (8 * size()));
+        }
+        if (current_pool() == this || workers_.empty() || n <= chunk) {
+            for (size_t i = 0; i < n; ++i) {
+                f(i);
+            }
+            return;
+        }
+
+        std::lock_guard loop_lock{ loop_mutex_ };
+        std::atomic<size_t> next{ 0 };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        const auto body = [&] {
+            for (size_t first = next.fetch_add(chunk); first < n; first = next.fetch_add(chunk)) {
+                try {
+                    for (size_t i = first; i < std::min(n, first + chunk); ++i) {
+                        f(i);
+                    }
+                } catch (...) {
+                    std::lock_guard lock{ error_mutex };
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    next.store(n);
+                }
+            }
+        };
+
+        {
+            std::lock_guard lock{ mutex_ };
+            job_ = body;
+            pending_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        {
+            // a worker of another pool stays one after the loop, even on unwind
+            const CurrentPool scope{ std::exchange(current_pool(), this) };
+            body();
+        }
+
+        std::unique_lock lock{ mutex_ };
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    static ThreadPool*& current_pool() {
+        thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    // restores the pool the thread was running for
+    struct CurrentPool {
+        ThreadPool* previous;
+
+        ~CurrentPool() {
+            current_pool() = previous;
+        }
+    };
+
+    void work() {
+        current_pool() = this;
+        uint64_t seen = 0;
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock{ mutex_ };
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                job = job_;
+            }
+            job();
+            {
+                std::lock_guard lock{ mutex_ };
+                --pending_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex loop_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void()> job_;
+    uint64_t generation_ = 0;
+    size_t pending_ = 0;
+    bool stop_ = false;
+};
+
+// pool shared by the library's parallel algorithms, one thread per core
+inline ThreadPool& default_thread_pool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+} // namespace veritacpp::utils
@@ -1,14 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <concepts>
-#include <type_traits>
 #include <cstdint>
+#include <functional>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace veritacpp::utils {
 
-namespace detail {    
+namespace detail {
 template <class T>
 struct IsTuple : std::false_type {};
 
@@ -20,35 +23,172 @@ struct IsTuple<std::tuple<T...>> : std::true_type {};
 template <class T>
 concept Tuple = detail::IsTuple<T>::value;
 
+namespace detail {
+
+// reference to element I of a view, T is a reference type
+template <uint64_t I, class T>
+struct ViewElement {
+    T ref;
+};
+
+template <class Seq, class... T>
+struct TupleViewBase;
+
+template <uint64_t... idx, class... T>
+struct TupleViewBase<std::integer_sequence<uint64_t, idx...>, T...> : ViewElement<idx, T>... {
+    constexpr explicit TupleViewBase(T... t) : ViewElement<idx, T>{ static_cast<T>(t) }... {}
+
+    template <uint64_t I>
+    constexpr decltype(auto) get() const {
+        return element<I>(*this);
+    }
+
+    // pack indexing by base class deduction: no recursive instantiations
+    template <uint64_t I, class U>
+    static constexpr U element(const ViewElement<I, U>& e) {
+        return static_cast<U>(e.ref);
+    }
+
+    template <uint64_t I, class U>
+    static std::type_identity<U> element_type(const ViewElement<I, U>&);
+};
+
+} // namespace detail
+
 /**
- * Split tuple into pair:
- * [0...split_pos), [split_pos...tuple_size)
+ * Tuple of references to elements stored elsewhere: slices, splits
+ * and concatenations of views copy no element.
+ * T... are reference types, as in std::forward_as_tuple: an element is
+ * an lvalue for T = U& and an xvalue for T = U&&. A view must not
+ * outlive what it refers to; views of temporaries are only valid
+ * until the end of the full expression that made them.
+ * Unlike std::tuple, elements are bases of one flat class, so views
+ * of any length instantiate a constant number of templates deep.
  */
-template <uint64_t split_pos, Tuple T>
-constexpr auto split(T t) {
-    constexpr auto t_size = std::tuple_size_v<T>;
-    if constexpr (split_pos == 0) {
-        return make_pair(
-            std::tuple<>{},
-            t
-        );
+template <class... T>
+struct TupleView
+    : detail::TupleViewBase<std::make_integer_sequence<uint64_t, sizeof...(T)>, T...> {
+
+    using detail::TupleViewBase<std::make_integer_sequence<uint64_t, sizeof...(T)>, T...>::TupleViewBase;
+
+    static constexpr size_t size = sizeof...(T);
+};
+
+namespace detail {
+
+template <class T>
+struct IsTupleView : std::false_type {};
+
+template <class... T>
+struct IsTupleView<TupleView<T...>> : std::true_type {};
+
+} // namespace detail
+
+template <class T>
+concept View = detail::IsTupleView<std::remove_cvref_t<T>>::value;
+
+// std::tuple or view
+template <class T>
+concept TupleLike = Tuple<std::remove_cvref_t<T>> || View<T>;
+
+template <class T>
+constexpr size_t tuple_size_v = std::tuple_size_v<std::remove_cvref_t<T>>;
+
+/**
+ * Element I of a tuple or view, with the value category
+ * of a member of t for tuples
+ */
+template <uint64_t I, TupleLike T>
+constexpr decltype(auto) get(T&& t) {
+    if constexpr (View<T>) {
+        return t.template get<I>();
+    } else {
+        return std::get<I>(std::forward<T>(t));
     }
-    if constexpr (split_pos >= t_size) {
-        return std::make_pair(t, std::tuple<>{});
-    } else { // else ommiting breaks conditional compilation!
-        auto get_right = [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
-            return std::make_tuple(std::get<split_pos + idx>(t)...); 
-        };
-        auto get_left = [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
-            return std::make_tuple(std::get<idx>(t)...); 
-        };
-        constexpr auto delta = t_size - split_pos;
-    
-        return std::make_pair(
-            get_left(std::make_index_sequence<split_pos>{}),
-            get_right(std::make_index_sequence<delta>{})
-        );
+}
+
+template <class... T>
+constexpr TupleView<T&&...> forward_as_view(T&&... t) {
+    return TupleView<T&&...>{ std::forward<T>(t)... };
+}
+
+/**
+ * View of elements [Begin, End) of a tuple or view
+ */
+template <uint64_t Begin, uint64_t End, TupleLike T>
+requires (Begin <= End && End <= tuple_size_v<T>)
+constexpr View auto slice(T&& t) {
+    return [&t]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) {
+        return TupleView<decltype(utils::get<Begin + idx>(std::forward<T>(t)))...>{
+            utils::get<Begin + idx>(std::forward<T>(t))... };
+    }(std::make_integer_sequence<uint64_t, End - Begin>{});
+}
+
+template <TupleLike T>
+constexpr View auto view(T&& t) {
+    return slice<0, tuple_size_v<T>>(std::forward<T>(t));
+}
+
+/**
+ * Split tuple into pair of views:
+ * [0...split_pos), [split_pos...tuple_size)
+ */
+template <uint64_t split_pos, TupleLike T>
+constexpr auto split(T&& t) {
+    constexpr auto pos = std::min<uint64_t>(split_pos, tuple_size_v<T>);
+    return std::make_pair(slice<0, pos>(std::forward<T>(t)),
+                          slice<pos, tuple_size_v<T>>(std::forward<T>(t)));
+}
+
+namespace detail {
+
+// (view, position in view) of every element of concatenated views
+template <class... Views>
+constexpr auto kConcatIndex = [] {
+    constexpr std::array<size_t, sizeof...(Views)> sizes = { Views::size... };
+    std::array<std::pair<size_t, size_t>, (Views::size + ... + 0)> index{};
+    size_t k = 0;
+    for (size_t v = 0; v < sizes.size(); ++v) {
+        for (size_t i = 0; i < sizes[v]; ++i) {
+            index[k++] = { v, i };
+        }
     }
+    return index;
+}();
+
+} // namespace detail
+
+/**
+ * View of the elements of all views, in order.
+ * Element k is looked up in a table made once per list of view types,
+ * not by recursion over the views.
+ */
+template <View... Views>
+constexpr View auto concat(const Views&... views) {
+    constexpr auto& index = detail::kConcatIndex<Views...>;
+    const auto all = std::forward_as_tuple(views...);
+    return [&all]<size_t... k>(std::index_sequence<k...>) {
+        return TupleView<decltype(std::get<index[k].first>(all).template get<index[k].second>())...>{
+            std::get<index[k].first>(all).template get<index[k].second>()... };
+    }(std::make_index_sequence<index.size()>{});
+}
+
+// f(elements of t...)
+template <class F, TupleLike T>
+constexpr decltype(auto) apply(F&& f, T&& t) {
+    return [&]<uint64_t... idx>(std::integer_sequence<uint64_t, idx...>) -> decltype(auto) {
+        return std::invoke(std::forward<F>(f), utils::get<idx>(std::forward<T>(t))...);
+    }(std::make_integer_sequence<uint64_t, tuple_size_v<T>>{});
 }
 
 }
+
+template <class... T>
+struct std::tuple_size<veritacpp::utils::TupleView<T...>>
+    : std::integral_constant<size_t, sizeof...(T)> {};
+
+template <size_t I, class... T>
+struct std::tuple_element<I, veritacpp::utils::TupleView<T...>> {
+    using type = typename decltype(veritacpp::utils::TupleView<T...>::template element_type<I>(
+        std::declval<const veritacpp::utils::TupleView<T...>&>()))::type;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace veritacpp::utils {
+
+/**
+ * Worker threads running independent tasks, with work stealing.
+ *
+ * Every worker owns a deque of tasks. Tasks submitted by a worker go to
+ * its own deque and it takes them back newest first, while they are
+ * still in its cache; an idle worker steals the oldest task of another
+ * deque, usually the largest piece of work left there. Tasks submitted
+ * from other threads are dealt to the deques in turn. Workers sleep
+ * only when no deque holds a task.
+ *
+ * Unlike ThreadPool, submit() does not wait: tasks run and finish on
+ * their own and report through whatever they capture. Tasks should
+ * not throw. The destructor runs every submitted task, then joins.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        threads = std::max<size_t>(1, threads);
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator = (const WorkStealingPool&) = delete;
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    void submit(std::function<void()> task) {
+        const auto [pool, index] = current_worker();
+        const size_t q = pool == this ? index : next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            // counted first: a worker seeing the count may find the task
+            // a moment later, but never sleeps while it is queued
+            std::lock_guard lock{ mutex_ };
+            ++queued_;
+        }
+        {
+            std::lock_guard lock{ queues_[q]->mutex };
+            queues_[q]->tasks.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct Worker {
+        const WorkStealingPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static Worker& current_worker() {
+        thread_local Worker worker;
+        return worker;
+    }
+
+    // newest task of queue i, or oldest of another one
+    std::function<void()> take(size_t i) {
+        std::function<void()> task;
+        {
+            std::lock_guard lock{ queues_[i]->mutex };
+            if (!queues_[i]->tasks.empty()) {
+                task = std::move(queues_[i]->tasks.back());
+                queues_[i]->tasks.pop_back();
+                return task;
+            }
+        }
+        for (size_t k = 1; k < queues_.size(); ++k) {
+            auto& victim = *queues_[(i + k) % queues_.size()];
+            std::lock_guard lock{ victim.mutex };
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return task;
+    }
+
+    void work(size_t i) {
+        current_worker() = { this, i };
+        while (true) {
+            if (auto task = take(i)) {
+                {
+                    std::lock_guard lock{ mutex_ };
+                    --queued_;
+                }
+                task();
+                continue;
+            }
+            std::unique_lock lock{ mutex_ };
+            wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+            if (stop_ && queued_ == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_{ 0 };
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    size_t queued_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace veritacpp::utils
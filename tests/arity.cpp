@@ -0,0 +1,73 @@
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+#include <veritacpp/dsl/math/tabulated.hpp>
+
+#include <cassert>
+#include <cmath>
+
+// function of the user, without a declared arity
+struct Hypot : veritacpp::dsl::math::BasicFunction {
+    double operator()(double a, double b, auto...) const {
+        return std::sqrt(a * a + b * b);
+    }
+};
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto z = Variable<2>{};
+
+    // largest variable index plus one
+    static_assert(arity_v<decltype(kOne)> == 0);
+    static_assert(arity_v<decltype(x)> == 1);
+    static_assert(arity_v<decltype(z)> == 3);
+    static_assert(arity_v<decltype(x * y + sin(x))> == 2);
+    static_assert(arity_v<decltype(z - x)> == 3);
+    static_assert(arity_v<decltype(sum_of(x, y, z, 2.0 * x))> == 3);
+    static_assert(arity_v<decltype(max(x, 1.0) + select(y, x, z))> == 3);
+    static_assert(arity_v<decltype(exp(z))> == 3);
+
+    // application: the gs replace the leading variables of f
+    static_assert(arity_v<decltype((x + y) | (kOne, kOne))> == 0);
+    static_assert(arity_v<decltype((x + y) | (z, x))> == 3);
+    static_assert(arity_v<decltype((x + z) | (y))> == 3);
+    static_assert(arity_v<decltype(sin(kOne))> == 0);
+
+    // derivatives keep the arity of what they differentiate, at most
+    static_assert(arity_v<decltype(diff(x * y, y))> == 1);
+    static_assert(arity_v<decltype(diff(x * y, z))> == 0);
+
+    // calls are checked against the arity
+    static_assert(NVariablesFunctional<3, decltype(x * z)>);
+    static_assert(!NVariablesFunctional<2, decltype(x * z)>);
+    static_assert(std::is_invocable_v<decltype(x * z), double, double, double>);
+    static_assert(!std::is_invocable_v<decltype(x * z), double, double>);
+
+    // functions of the user are probed
+    static_assert(arity_v<Hypot> == 2);
+    static_assert(NVariablesFunctional<2, Hypot>);
+    static_assert(!NVariablesFunctional<1, Hypot>);
+    assert(((Hypot{} | (x, y)) * z)(3.0, 4.0, 2.0) == 10.0);
+
+    // deep derivative chains
+    {
+        constexpr auto f = sin(x * y) * exp(y) + log(x + z);
+        constexpr auto d = diff(diff(diff(diff(f, x), y), x), y);
+        static_assert(arity_v<decltype(d)> == 2); // log(x + z) vanished
+        const auto h = 1e-3;
+        const auto g = [&](double a, double b) { return diff(diff(f, x), y)(a, b, 0.5); };
+        const double expected = (g(1.2 + h, 0.7 + h) - g(1.2 + h, 0.7 - h)
+                                 - g(1.2 - h, 0.7 + h) + g(1.2 - h, 0.7 - h)) / (4 * h * h);
+        assert(std::abs(d(1.2, 0.7, 0.5) - expected) < 1e-4 * (1 + std::abs(expected)));
+    }
+
+    // tabulated functions take one variable
+    {
+        const auto t = tabulate(sin(x), 0.0, 1.0, 64);
+        static_assert(arity_v<decltype(t | (y))> == 2);
+    }
+
+}
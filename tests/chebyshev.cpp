@@ -0,0 +1,77 @@
+#include <veritacpp/dsl/math/chebyshev.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+
+#include <cassert>
+#include <cmath>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // smooth compositions are resolved to the tolerance with a low degree
+    {
+        const auto f = exp(sin(3.0 * x)) * log(2.0 + x) + (cos(x) | (x * x));
+        const auto p = chebyshev(f, x, -1.0, 2.0, 1e-12);
+        assert(p.error <= 1e-12 && p.degree() < 100);
+        double worst = 0;
+        for (double t = -1; t <= 2; t += 0.0007) {
+            worst = std::max(worst, std::abs(p(t) - f(t)));
+        }
+        assert(worst <= 1e-12);
+        assert(evaluate(p, 0.5) == p(0.5));
+
+        // derivatives in closed form, and of higher order
+        const auto dp = diff(p, x);
+        const auto df = diff(f, x);
+        const auto d2p = diff(dp, x);
+        const auto d2f = diff(df, x);
+        for (double t = -1; t <= 2; t += 0.01) {
+            assert(std::abs(dp(t) - df(t)) < 1e-9);
+            assert(std::abs(d2p(t) - d2f(t)) < 1e-6);
+        }
+        assert(std::isnan(dp.error));
+        static_assert(std::same_as<decltype(diff(p, y)), std::remove_const_t<decltype(kZero)>>);
+
+        // a polynomial is reproduced with its own degree
+        const auto q = chebyshev(3.0 * (x^Constant<3>{}) - x + 1.0, x, 0.0, 4.0, 1e-13);
+        assert(q.degree() == 3);
+        assert(std::abs(q(2.5) - (3 * 2.5 * 2.5 * 2.5 - 2.5 + 1)) < 1e-11);
+    }
+
+    // the proxy variable among others: y is the variable, x a coefficient
+    {
+        const auto f = exp(-x * y) / (1.0 + y * y);
+        const auto p = chebyshev(f, y, 0.0, 3.0, 1e-10, 0.7);
+        for (double t = 0; t <= 3; t += 0.01) {
+            assert(std::abs(p(123.0, t) - f(0.7, t)) < 1e-10);
+        }
+    }
+
+    // kinks are not resolved: the estimate says so
+    {
+        const auto p = chebyshev(abs(x - 0.1), x, -1.0, 1.0, 1e-12);
+        assert(p.error > 1e-12);
+        assert(std::abs(p(0.5) - 0.4) < 1e-3);
+    }
+
+    // two variables
+    {
+        const auto g = exp(-x * x - y) * cos(2.0 * x * y);
+        const auto p = chebyshev(g, x, y, { -1.0, 1.0 }, { 0.0, 1.0 }, 1e-10);
+        assert(p.error <= 1e-10 && p.rows < 40 && p.columns < 40);
+        const auto dx = diff(p, x);
+        const auto dy = diff(p, y);
+        const auto gx = diff(g, x);
+        const auto gy = diff(g, y);
+        for (double u = -1; u <= 1; u += 0.05) {
+            for (double v = 0; v <= 1; v += 0.05) {
+                assert(std::abs(p(u, v) - g(u, v)) < 1e-10);
+                assert(std::abs(dx(u, v) - gx(u, v)) < 1e-7);
+                assert(std::abs(dy(u, v) - gy(u, v)) < 1e-7);
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include <veritacpp/dsl/math/columns.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void write_column(const std::string& path, const std::vector<double>& values) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    assert(file);
+    std::fwrite(values.data(), sizeof(double), values.size(), file);
+    std::fclose(file);
+}
+
+std::vector<double> read_column(const std::string& path) {
+    std::vector<double> values;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    assert(file);
+    double v;
+    while (std::fread(&v, sizeof v, 1, file) == 1) {
+        values.push_back(v);
+    }
+    std::fclose(file);
+    return values;
+}
+
+} // namespace
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    const size_t rows = 250'003;
+    std::vector<double> xs(rows), ys(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        xs[i] = i * 1e-5 - 1;
+        ys[i] = std::sin(i * 0.001);
+    }
+    write_column("columns_x.bin", xs);
+    write_column("columns_y.bin", ys);
+
+    const auto f = exp(-x * x) * cos(y) + clamp(x * y, -0.5, 0.5);
+
+    // several windows, chunks not aligned to pages, a partial last chunk
+    {
+        const auto r = evaluate_columns(f, { "columns_x.bin", "columns_y.bin" }, "columns_out.bin",
+                                        { .chunk_rows = 1000, .window_chunks = 7 });
+        assert(r.status == ColumnStatus::Ok && r.rows == rows);
+        const auto out = read_column("columns_out.bin");
+        assert(out.size() == rows);
+        for (size_t i = 0; i < rows; ++i) {
+            assert(out[i] == f(xs[i], ys[i]));
+        }
+    }
+
+    // default options and a mapped expression image
+    {
+        const auto bytes = serialize(f);
+        const ExpressionImage image{ bytes };
+        const auto r = evaluate_columns(image, { "columns_x.bin", "columns_y.bin" }, "columns_out.bin");
+        assert(r.status == ColumnStatus::Ok && r.rows == rows);
+        const auto out = read_column("columns_out.bin");
+        for (size_t i = 0; i < rows; i += 7) {
+            assert(std::abs(out[i] - f(xs[i], ys[i])) < 1e-14);
+        }
+
+        const auto fast = evaluate_columns<FastMath<1e-12>>(f, { "columns_x.bin", "columns_y.bin" },
+                                                           "columns_out.bin");
+        assert(fast.status == ColumnStatus::Ok);
+        const auto fast_out = read_column("columns_out.bin");
+        for (size_t i = 0; i < rows; i += 7) {
+            assert(std::abs(fast_out[i] - f(xs[i], ys[i])) < 1e-11);
+        }
+    }
+
+    // errors
+    {
+        write_column("columns_short.bin", std::vector<double>(10));
+        assert(evaluate_columns(f, { "columns_x.bin", "columns_short.bin" }, "columns_out.bin").status ==
+               ColumnStatus::SizeMismatch);
+        assert(evaluate_columns(f, { "columns_x.bin", "columns_missing.bin" }, "columns_out.bin").status ==
+               ColumnStatus::IoError);
+
+        // the output is an input, by name or through a hard link
+        assert(evaluate_columns(f, { "columns_x.bin", "columns_y.bin" }, "columns_y.bin").status ==
+               ColumnStatus::OutputIsInput);
+        std::filesystem::create_hard_link("columns_x.bin", "columns_link.bin");
+        assert(evaluate_columns(f, { "columns_x.bin", "columns_y.bin" }, "columns_link.bin").status ==
+               ColumnStatus::OutputIsInput);
+        assert(read_column("columns_x.bin") == xs);
+
+        // images that cannot run over these columns
+        constexpr auto z = Variable<2>{};
+        const auto wide = serialize(x + z);
+        assert(evaluate_columns(ExpressionImage{ wide }, { "columns_x.bin", "columns_y.bin" },
+                                "columns_out.bin").status == ColumnStatus::InvalidImage);
+        assert(evaluate_columns(ExpressionImage{}, { "columns_x.bin" }, "columns_out.bin").status ==
+               ColumnStatus::InvalidImage);
+
+        write_column("columns_empty.bin", {});
+        const auto r = evaluate_columns(sin(x), { "columns_empty.bin" }, "columns_out.bin");
+        assert(r.status == ColumnStatus::Ok && r.rows == 0 && read_column("columns_out.bin").empty());
+    }
+
+    for (const char* path : { "columns_x.bin", "columns_y.bin", "columns_out.bin",
+                              "columns_short.bin", "columns_empty.bin", "columns_link.bin" }) {
+        std::remove(path);
+    }
+}
@@ -0,0 +1,84 @@
+#include <veritacpp/dsl/math/constexpr_math.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+constexpr size_t kPoints = 256;
+
+// values of f computed during constant evaluation
+template <class F>
+constexpr std::array<double, kPoints> tabulate(F f, double from, double to) {
+    std::array<double, kPoints> r{};
+    for (size_t i = 0; i < kPoints; ++i) {
+        r[i] = f(from + (to - from) * i / (kPoints - 1));
+    }
+    return r;
+}
+
+// distance in units of last place
+int64_t ulps(double a, double b) {
+    const auto d = std::bit_cast<int64_t>(a) - std::bit_cast<int64_t>(b);
+    return d < 0 ? -d : d;
+}
+
+template <class G>
+void check(const std::array<double, kPoints>& folded, G runtime, double from, double to) {
+    for (size_t i = 0; i < kPoints; ++i) {
+        const double x = from + (to - from) * i / (kPoints - 1);
+        assert(ulps(folded[i], runtime(x)) <= 1);
+    }
+}
+
+}
+
+int main() {
+
+    namespace cm = veritacpp::dsl::math::constexpr_math;
+    using namespace veritacpp::dsl::math;
+
+    static_assert(cm::sin(0.5) == 0.479425538604203);
+    static_assert(cm::cos(2.0) == -0.4161468365471424);
+    static_assert(cm::exp(1.0) == 2.718281828459045);
+    static_assert(cm::log(10.0) == 2.302585092994046);
+    static_assert(cm::pow(2.0, 0.5) == 1.4142135623730951);
+    static_assert(cm::pow(5, 3) == 125);
+    static_assert(cm::pow(2.0, -2) == 0.25);
+    static_assert(cm::pow(-2.0, 3) == -8);
+    static_assert(cm::exp(0) == 1 && cm::log(1) == 0 && cm::sin(0) == 0);
+    static_assert(cm::log(0.0) == -std::numeric_limits<double>::infinity());
+    static_assert(cm::exp(1000.0) == std::numeric_limits<double>::infinity());
+    static_assert(cm::exp(-1000.0) == 0);
+    static_assert(cm::sin(1.5f) == 0.997495f);
+
+    // constant subtrees fold into Constant nodes
+    {
+        constexpr auto c = sin(Constant<1.0>{}) * exp(Constant<2.0>{}) +
+                           (Constant<3.0>{} ^ Constant<0.5>{});
+        static_assert(std::is_same_v<std::remove_cvref_t<decltype(c)>,
+                                     Constant<c(0)>>);
+    }
+
+    // folded values agree with runtime ones up to the last bit
+    {
+        constexpr auto sin_table = tabulate([](double x) { return cm::sin(x); }, -100, 100);
+        check(sin_table, [](double x) { return std::sin(x); }, -100, 100);
+
+        constexpr auto cos_table = tabulate([](double x) { return cm::cos(x); }, -100, 100);
+        check(cos_table, [](double x) { return std::cos(x); }, -100, 100);
+
+        constexpr auto exp_table = tabulate([](double x) { return cm::exp(x); }, -700, 700);
+        check(exp_table, [](double x) { return std::exp(x); }, -700, 700);
+
+        constexpr auto log_table = tabulate([](double x) { return cm::log(x); }, 1e-3, 1e3);
+        check(log_table, [](double x) { return std::log(x); }, 1e-3, 1e3);
+
+        constexpr auto pow_table = tabulate([](double x) { return cm::pow(x, 2.37); }, 0, 50);
+        check(pow_table, [](double x) { return std::pow(x, 2.37); }, 0, 50);
+    }
+
+}
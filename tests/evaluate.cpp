@@ -0,0 +1,87 @@
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // default policy gives the same results as a direct call
+    {
+        constexpr auto f = (x^2) * y + 3 * (x | (x, y)) - x / y;
+        static_assert(evaluate(f, 2, 4) == f(2, 4));
+        static_assert(evaluate<Precise>(f, 3.0, 0.5) == f(3.0, 0.5));
+
+        constexpr auto g = sin(x) * exp(y) + cos(x * y) - log(x + 1.0);
+        assert(evaluate(g, 0.3, 1.7) == g(0.3, 1.7));
+    }
+
+    // polynomial kernels stay within documented error bounds
+    {
+        using Fast = FastMath<1e-7>;
+        static_assert(fast::exp_error_bound(Fast::kExpDegree) <= 1e-7);
+        static_assert(fast::log_error_bound(Fast::kLogTerms) <= 1e-7);
+        static_assert(fast::sin_error_bound(Fast::kSinDegree) <= 1e-7);
+
+        constexpr double ulps = 1e-14;
+        for (double t = -50; t <= 50; t += 0.0137) {
+            assert(std::abs(evaluate<Fast>(sin(x), t) - std::sin(t)) <= 1e-7 + ulps);
+            assert(std::abs(evaluate<Fast>(cos(x), t) - std::cos(t)) <= 1e-7 + ulps);
+            const double e = std::exp(t);
+            assert(std::abs(evaluate<Fast>(exp(x), t) - e) <= (1e-7 + ulps) * e);
+        }
+        for (double t = 1e-300; t < 1e300; t *= 1.37) {
+            const double l = std::log(t);
+            assert(std::abs(evaluate<Fast>(log(x), t) - l) <= (1e-7 + ulps) * std::abs(l));
+        }
+        assert(std::abs(evaluate<Fast>(log(x), 1.0 + 1e-9) - std::log(1.0 + 1e-9)) <= 1e-24);
+        assert(std::isinf(evaluate<Fast>(log(x), 0.0)));
+        assert(std::isnan(evaluate<Fast>(log(x), -1.0)));
+        assert(evaluate<Fast>(exp(x), 1000.0) == INFINITY);
+        assert(evaluate<Fast>(exp(x), -1000.0) < 1e-300);
+        assert(std::abs(evaluate<Fast>(exp(x), 709.7) / std::exp(709.7) - 1) < 1e-7);
+
+        assert(std::abs(evaluate<Fast>(sin(x), 1.5f) - std::sin(1.5f)) < 1e-6f);
+        assert(std::abs(evaluate<Fast>(exp(x), 2.5f) - std::exp(2.5f)) < 1e-5f);
+
+        // tighter tolerance selects higher degrees
+        using Precise12 = FastMath<1e-12>;
+        static_assert(Precise12::kExpDegree > Fast::kExpDegree);
+        assert(std::abs(evaluate<Precise12>(sin(x), 2.0) - std::sin(2.0)) <= 1e-12);
+    }
+
+    // policy reaches every node of compound expressions and derivatives
+    {
+        using Fast = FastMath<1e-9>;
+        constexpr auto f = sin(x * y) * exp(-x) + (log(y) ^ Constant<3>{});
+        constexpr auto df = diff(f, x);
+        for (double a = 0.1; a < 3; a += 0.1) {
+            assert(std::abs(evaluate<Fast>(f, a, 2 * a) - f(a, 2 * a)) < 1e-7);
+            assert(std::abs(evaluate<Fast>(df, a, 2 * a) - df(a, 2 * a)) < 1e-7);
+        }
+        constexpr auto p = (x ^ Constant<-2>{}) + (x ^ 1.5);
+        assert(std::abs(evaluate<Fast>(p, 3.0) - p(3.0)) < 1e-8);
+    }
+
+    // batched evaluation
+    {
+        constexpr auto f = exp(-x * x) * cos(y);
+        std::vector<double> xs(1000), ys(1000), out(1000), fast_out(1000);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            xs[i] = i * 0.003;
+            ys[i] = i * 0.01;
+        }
+        evaluate_batch(f, out, xs, ys);
+        evaluate_batch<FastMath<1e-7>>(f, fast_out, xs, ys);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            assert(out[i] == f(xs[i], ys[i]));
+            assert(std::abs(fast_out[i] - out[i]) < 2e-7);
+        }
+    }
+}
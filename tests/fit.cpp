@@ -0,0 +1,101 @@
+#include <veritacpp/dsl/math/fit.hpp>
+#include <veritacpp/dsl/math/linalg.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    // dense solvers
+    {
+        constexpr linalg::Matrix<3> a = {{ { 4, 2, 0.4 }, { 2, 5, 1 }, { 0.4, 1, 3 } }};
+        constexpr linalg::Vector<3> x = { 1, -2, 0.5 };
+        constexpr auto b = linalg::multiply(a, x);
+
+        auto c = b;
+        assert(linalg::cholesky_solve(a, c));
+        const linalg::LU<3> lu{ a };
+        assert(!lu.singular);
+        const auto l = lu.solve(b);
+        for (size_t i = 0; i < 3; ++i) {
+            assert(std::abs(c[i] - x[i]) < 1e-14);
+            assert(std::abs(l[i] - x[i]) < 1e-14);
+        }
+
+        auto d = b;
+        assert(!linalg::cholesky_solve(linalg::Matrix<3>{{ { 1, 2, 0 }, { 2, 1, 0 }, { 0, 0, 1 } }}, d));
+        assert(linalg::LU<2>({{ { 1, 2 }, { 2, 4 } }}).singular);
+    }
+
+    constexpr auto a = Variable<0>{};
+    constexpr auto b = Variable<1>{};
+    constexpr auto c = Variable<2>{};
+    constexpr auto t = Variable<3>{};
+
+    // exponential decay with deterministic noise, several blocks of points
+    {
+        const auto model = a * exp(b * t) + c;
+        constexpr size_t n = 2000;
+        std::vector<double> ts(n), ys(n);
+        for (size_t i = 0; i < n; ++i) {
+            ts[i] = 0.005 * double(i);
+            ys[i] = 2.5 * std::exp(-1.3 * ts[i]) + 0.5 + 1e-3 * std::sin(7.0 * double(i));
+        }
+        const auto result = fit(model, std::array{ 1.0, -0.5, 0.0 }, ts, ys);
+        assert(result.status == FitStatus::Converged);
+        assert(std::abs(result.params[0] - 2.5) < 1e-3);
+        assert(std::abs(result.params[1] + 1.3) < 1e-3);
+        assert(std::abs(result.params[2] - 0.5) < 1e-3);
+        assert(result.residual_sum_of_squares < n * 1e-6);
+
+        // fast kernels converge to the same parameters
+        const auto fast = fit<FastMath<1e-12>>(model, std::array{ 1.0, -0.5, 0.0 }, ts, ys);
+        for (size_t i = 0; i < 3; ++i) {
+            assert(std::abs(fast.params[i] - result.params[i]) < 1e-8);
+        }
+    }
+
+    // exact data of a model linear in its parameters
+    {
+        const auto model = a + b * t + c * (t^Constant<2>{});
+        std::vector<double> ts, ys;
+        for (double x = -2; x <= 2; x += 0.25) {
+            ts.push_back(x);
+            ys.push_back(1 - 3 * x + 0.5 * x * x);
+        }
+        const auto result = fit(model, std::array{ 0.0, 0.0, 0.0 }, ts, ys);
+        assert(result.status == FitStatus::Converged);
+        assert(std::abs(result.params[0] - 1) < 1e-9);
+        assert(std::abs(result.params[1] + 3) < 1e-9);
+        assert(std::abs(result.params[2] - 0.5) < 1e-9);
+        assert(result.residual_sum_of_squares < 1e-18);
+    }
+
+    // a model that is NaN at every trial never decreases the sum of squares:
+    // the data ask for b > 1, where the model is log of a negative number;
+    // no step tolerance, so the shrinking steps are not taken for convergence
+    {
+        const auto model = a * t + c + select(b - 1.0, log(-b), b - 1.0);
+        const std::vector<double> ts = { 0, 1, 2, 3 };
+        const std::vector<double> ys = { 1.5, 2.5, 3.5, 4.5 };
+        const auto result = fit(model, std::array{ 1.0, 1.0, 1.0 }, ts, ys, { .tolerance = 0 });
+        assert(result.status == FitStatus::Stalled);
+        assert(result.params[1] == 1);
+    }
+
+    // not finite at the start: NaN residuals, or one NaN column of the
+    // Jacobian that is not the last one (d/db of b^0.5 at b = 0)
+    {
+        const std::vector<double> ts = { 0, 1, 2, 3 };
+        const std::vector<double> ys = { 1, 2, 3, 4 };
+        const auto nan_residuals = fit(a * t + log(b) + c, std::array{ 1.0, -1.0, 0.0 }, ts, ys);
+        assert(nan_residuals.status == FitStatus::NotFinite && nan_residuals.iterations == 0);
+
+        const auto nan_column = fit(a + (b ^ 0.5) + c * t, std::array{ 1.0, 0.0, 1.0 }, ts, ys);
+        assert(nan_column.status == FitStatus::NotFinite && nan_column.iterations == 0);
+    }
+}
@@ -0,0 +1,115 @@
+#include <veritacpp/dsl/math/interval.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // enclosures contain the exact range and are tight up to rounding
+    {
+        const auto r = bound(x * x - 2.0 * x, Box<1>{ Interval{ 0, 3 } });
+        assert(r.lo <= -6 && r.hi >= 9); // natural extension: x * x and 2x are independent
+        const auto p = bound((x^Constant<2>{}) - 2.0 * x, Box<1>{ Interval{ -1, 1 } });
+        assert(p.lo <= -2 && p.lo > -2.001 && p.hi >= 3 && p.hi < 3.001);
+
+        const auto s = bound(sin(x), Box<1>{ Interval{ 0, 2 } });
+        assert(s.hi == 1 && s.lo <= 0 && s.lo > -1e-15);
+        const auto c = bound(cos(x), Box<1>{ Interval{ 3, 4 } });
+        assert(c.lo == -1 && c.hi >= std::cos(4.0) && c.hi < std::cos(4.0) + 1e-15);
+        const auto full = bound(sin(x), Box<1>{ Interval{ -10, 10 } });
+        assert(full == Interval(-1, 1));
+
+        const auto e = bound(exp(x) + log(y), Box<2>{ Interval{ 0, 1 }, Interval{ 1, std::numbers::e } });
+        assert(e.lo <= 1 && e.lo > 1 - 1e-14);
+        assert(e.hi >= std::numbers::e + 1 && e.hi < std::numbers::e + 1 + 1e-14);
+
+        const auto q = bound(1.0 / x, Box<1>{ Interval{ -1, 1 } });
+        assert(q == Interval::entire());
+        const auto odd = bound(x^Constant<3>{}, Box<1>{ Interval{ -2, 1 } });
+        assert(odd.lo <= -8 && odd.hi >= 1);
+
+        // the result contains point values
+        const auto f = sin(x * y) + exp(-1.0 * y) / (2.0 + cos(x));
+        const Box<2> box{ Interval{ -1, 2 }, Interval{ 0.5, 1.5 } };
+        const auto r2 = bound(f, box);
+        for (int i = 0; i <= 20; ++i) {
+            for (int j = 0; j <= 20; ++j) {
+                const double u = -1 + 3.0 * i / 20, v = 0.5 + j / 20.0;
+                assert(r2.contains(f(u, v)));
+            }
+        }
+    }
+
+    // global minimum of the six hump camel function: -1.0316 at (0.0898, -0.7126) and its mirror
+    {
+        const auto x2 = x^Constant<2>{};
+        const auto y2 = y^Constant<2>{};
+        const auto f = (4.0 - 2.1 * x2 + (x^Constant<4>{}) / 3.0) * x2 + x * y + (-4.0 + 4.0 * y2) * y2;
+        const auto m = minimize_global<2>(f, { Interval{ -3, 3 }, Interval{ -2, 2 } },
+                                          { .tolerance = 1e-6 });
+        assert(m.status == BranchAndBoundStatus::Converged);
+        assert(std::abs(m.value + 1.0316284534898774) < 1e-5);
+        assert(m.lower_bound <= m.value && m.value - m.lower_bound <= 1e-6 * std::abs(m.value) + 1e-12);
+        assert(std::abs(std::abs(m.x[0]) - 0.0898) < 1e-2 && std::abs(std::abs(m.x[1]) - 0.7126) < 1e-2);
+
+        // results do not depend on scheduling
+        const auto again = minimize_global<2>(f, { Interval{ -3, 3 }, Interval{ -2, 2 } },
+                                              { .tolerance = 1e-6 });
+        assert(again.x == m.x && again.value == m.value && again.boxes == m.boxes);
+
+        const auto cut = minimize_global<2>(f, { Interval{ -3, 3 }, Interval{ -2, 2 } },
+                                            { .tolerance = 1e-12, .max_boxes = 100 });
+        assert(cut.status == BranchAndBoundStatus::MaxBoxes);
+        assert(cut.lower_bound <= -1.0316284534898774);
+    }
+
+    // roots of sin over [-1, 10]: 0, pi, 2 pi, 3 pi, each isolated
+    {
+        const auto roots = isolate_roots(sin(x), Interval{ -1, 10 }, { .tolerance = 1e-9 });
+        assert(roots.size() >= 4);
+        const double expected[] = { 0, std::numbers::pi, 2 * std::numbers::pi, 3 * std::numbers::pi };
+        for (double z : expected) {
+            bool found = false;
+            for (const auto& r : roots) {
+                if (r.x.contains(z)) {
+                    found = true;
+                    assert(r.x.width() <= 1e-9);
+                }
+            }
+            assert(found);
+        }
+        for (const auto& r : roots) {
+            bool near = false;
+            for (double z : expected) {
+                near = near || std::abs(r.x.midpoint() - z) < 1e-8;
+            }
+            assert(near);
+        }
+        size_t unique = 0;
+        for (const auto& r : roots) {
+            unique += r.unique;
+        }
+        assert(unique >= 3);
+
+        // a budget smaller than a level: the intervals left still cover the zeros
+        const auto coarse = isolate_roots(sin(x), Interval{ -1, 10 }, { .max_boxes = 6 });
+        for (double z : expected) {
+            bool found = false;
+            for (const auto& r : coarse) {
+                found = found || r.x.contains(z);
+            }
+            assert(found);
+        }
+
+        // no roots
+        assert(isolate_roots(exp(x) + 1.0, Interval{ -5, 5 }).empty());
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/functions.hpp>
+
+#include <type_traits>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // stateless nodes take no space inside composites
+    static_assert(std::is_empty_v<decltype(x + x)>);
+    static_assert(std::is_empty_v<decltype(x * y - x / y)>);
+    static_assert(std::is_empty_v<decltype(sin(x) * cos(y) + exp(x))>);
+    static_assert(std::is_empty_v<decltype((x ^ Constant<3>{}) + log(x + y))>);
+    static_assert(std::is_empty_v<decltype(-x)>);
+    static_assert(std::is_empty_v<decltype(diff(sin(x * y) * (x ^ Constant<4>{}), x))>);
+    static_assert(std::is_empty_v<decltype((x + y) | (x, 2 * y))> == false);
+
+    // expression size is the size of its runtime payload
+    static_assert(sizeof(3.0 * x) == sizeof(double));
+    static_assert(sizeof(3.0 * x + 2.0 * y) == 2 * sizeof(double));
+    static_assert(sizeof(sin(3.0 * x) + x * y * 5.0) == 2 * sizeof(double));
+    static_assert(sizeof(exp(x * 2.0) | (x, sin(y) * 3.0)) == 2 * sizeof(double));
+    static_assert(sizeof((x + 1.0) * (x + 1.0) * (x + 1.0)) == 3 * sizeof(double));
+    static_assert(sizeof(x ^ 2.5) == sizeof(double));
+
+    // stateless expressions are still usable after layout compaction
+    {
+        constexpr auto f = (x + y) * (x - y);
+        static_assert(f(3, 2) == 5);
+        static_assert(diff(f, x)(3, 2) == 6);
+
+        constexpr auto g = (x * 2.0 + y * 3.0) | (y, x);
+        static_assert(g(1, 2) == 7);
+    }
+
+}
@@ -0,0 +1,114 @@
+#include <veritacpp/dsl/math/monte_carlo.hpp>
+
+#include <veritacpp/utils/philox.hpp>
+#include <veritacpp/utils/thread_pool.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+    using veritacpp::utils::Philox4x32;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // known answers of Philox4x32-10 (Random123)
+    static_assert(Philox4x32::generate({ 0, 0, 0, 0 }, { 0, 0 }) ==
+                  Philox4x32::Counter{ 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 });
+    static_assert(Philox4x32::generate({ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+                                       { 0xffffffff, 0xffffffff }) ==
+                  Philox4x32::Counter{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd });
+    static_assert(Philox4x32::generate({ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 },
+                                       { 0xa4093822, 0x299f31d0 }) ==
+                  Philox4x32::Counter{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 });
+
+    // uniforms stay in (0, 1]
+    for (uint64_t i = 0; i < 1000; ++i) {
+        const auto u = Philox4x32::uniform(7, 3, i);
+        assert(u[0] > 0 && u[0] <= 1 && u[1] > 0 && u[1] <= 1);
+    }
+
+    // moments of the distributions, within a few standard errors
+    const uint64_t n = 200'000;
+    {
+        const auto m = monte_carlo(x, n, Uniform{ 2, 5 });
+        assert(m.status == MonteCarloStatus::Success && m.samples == n);
+        assert(std::abs(m.mean - 3.5) < 5 * m.error);
+        assert(std::abs(m.variance - 0.75) < 0.02);
+    }
+    {
+        const auto m = monte_carlo(x, n, Normal{ 1, 2 });
+        assert(std::abs(m.mean - 1) < 5 * m.error);
+        assert(std::abs(m.variance - 4) < 0.1);
+
+        const auto e = monte_carlo(x, n, Exponential{ 4 });
+        assert(std::abs(e.mean - 0.25) < 5 * e.error);
+    }
+
+    // several variables: E[x y] = E[x] E[y] for independent draws
+    {
+        const auto m = monte_carlo(x * y, n, { .seed = 42 }, Uniform{ 0, 2 }, Normal{ 3, 1 });
+        assert(std::abs(m.mean - 3) < 5 * m.error);
+    }
+
+    // a call price against Black-Scholes
+    {
+        const double s0 = 100, k = 105, sigma = 0.2;
+        const auto call = max(s0 * exp(x) - k, 0.0);
+        const auto m = monte_carlo(call, n, Normal{ -sigma * sigma / 2, sigma });
+        const double d1 = (std::log(s0 / k) + sigma * sigma / 2) / sigma;
+        const double d2 = d1 - sigma;
+        const auto cdf = [](double v) { return 0.5 * std::erfc(-v / std::numbers::sqrt2); };
+        const double exact = s0 * cdf(d1) - k * cdf(d2);
+        assert(std::abs(m.mean - exact) < 5 * m.error);
+
+        // fast kernels see the same draws
+        const auto fast = monte_carlo<FastMath<1e-12>>(call, n, Normal{ -sigma * sigma / 2, sigma });
+        assert(std::abs(fast.mean - m.mean) < 1e-9);
+    }
+
+    // bit reproducible: the same seed gives the same result on pools
+    // of any size
+    {
+        const auto f = sin(x) * exp(y);
+        const auto a = monte_carlo(f, 100'000, { .seed = 9 }, Normal{}, Uniform{ -1, 1 });
+        const auto b = monte_carlo(f, 100'000, { .seed = 9 }, Normal{}, Uniform{ -1, 1 });
+        assert(a.mean == b.mean && a.variance == b.variance);
+
+        for (size_t threads : { 1, 7 }) {
+            veritacpp::utils::ThreadPool pool{ threads };
+            const auto c = monte_carlo(f, 100'000, { .seed = 9, .pool = &pool }, Normal{}, Uniform{ -1, 1 });
+            assert(c.mean == a.mean && c.variance == a.variance && c.error == a.error);
+        }
+
+        const auto other = monte_carlo(f, 100'000, { .seed = 10 }, Normal{}, Uniform{ -1, 1 });
+        assert(other.mean != a.mean);
+
+        // a longer run begins with the same samples
+        const auto one = monte_carlo(x, 1, { .seed = 9 }, Normal{});
+        assert(one.mean == Normal{}.sample(Philox4x32::uniform(9, 0, 0)[0],
+                                           Philox4x32::uniform(9, 0, 0)[1]));
+    }
+
+    // f not finite
+    {
+        const auto m = monte_carlo(log(x), 1000, Uniform{ -1, 1 });
+        assert(m.status == MonteCarloStatus::NotFinite);
+    }
+
+    // no samples, no estimate; one sample, a mean without a spread
+    {
+        const auto m = monte_carlo(x, 0, Uniform{});
+        assert(m.status == MonteCarloStatus::TooFewSamples && m.samples == 0);
+        assert(std::isnan(m.mean) && std::isnan(m.variance) && std::isnan(m.error));
+
+        const auto one = monte_carlo(x, 1, Uniform{ 2, 5 });
+        assert(one.status == MonteCarloStatus::TooFewSamples && one.samples == 1);
+        assert(one.mean >= 2 && one.mean <= 5);
+        assert(std::isnan(one.variance) && std::isnan(one.error));
+    }
+
+}
@@ -0,0 +1,70 @@
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto z = Variable<2>{};
+
+    // operators flatten chains into a single node
+    static_assert(std::is_same_v<decltype(x + y), Add<Variable<0>, Variable<1>>>);
+    static_assert(std::is_same_v<decltype(x + y + z),
+                                 Sum<Variable<0>, Variable<1>, Variable<2>>>);
+    static_assert(std::is_same_v<decltype((x + y) + (z + x)),
+                                 Sum<Variable<0>, Variable<1>, Variable<2>, Variable<0>>>);
+    static_assert(std::is_same_v<decltype(x * y * z),
+                                 Product<Variable<0>, Variable<1>, Variable<2>>>);
+    static_assert(std::is_same_v<decltype(x * (y * z) * sin(x)),
+                                 Product<Variable<0>, Variable<1>, Variable<2>, decltype(sin(x))>>);
+
+    {
+        constexpr auto f = x + y * z + z + 1.5;
+        static_assert(f(1, 2, 3) == 1 + 6 + 3 + 1.5);
+        static_assert(diff(f, z)(1, 2, 3) == 3);
+
+        constexpr auto g = x * y * z * 2.0;
+        static_assert(g(1, 2, 3) == 12);
+        static_assert(diff(g, x)(1, 2, 3) == 12);
+        static_assert(diff(g, y)(1, 2, 3) == 6);
+        static_assert(std::is_same_v<decltype(diff(x * y * y, z)), Constant<0>>);
+    }
+
+    // index driven builders
+    {
+        // 1 + x + x^2/2 + ... : Taylor series of exp with 20 terms
+        constexpr auto taylor = sum<20>([x](auto i) {
+            constexpr double inv_factorial = [] {
+                double r = 1;
+                for (uint64_t k = 2; k <= decltype(i)::value; ++k) {
+                    r /= k;
+                }
+                return r;
+            }();
+            return (x ^ Constant<decltype(i)::value>{}) * inv_factorial;
+        });
+        static_assert(std::tuple_size_v<decltype(taylor.terms())> == 20);
+        assert(std::abs(taylor(1.0) - std::exp(1.0)) < 1e-15);
+        assert(std::abs(diff(taylor, x)(0.5) - std::exp(0.5)) < 1e-15);
+
+        constexpr auto poly = product<5>([x](auto i) { return x - double(i); });
+        static_assert(poly(3.0) == 0 && poly(5.0) == 5 * 4 * 3 * 2 * 1);
+        static_assert(diff(poly, x)(0.0) == 24);
+    }
+
+    // deep sums do not nest types
+    {
+        constexpr auto many = sum<200>([x](auto i) { return x * double(i); });
+        static_assert(std::tuple_size_v<decltype(many.terms())> == 200);
+        static_assert(many(1.0) == 199 * 200 / 2);
+        static_assert(diff(many, x)(0.0) == 199 * 200 / 2);
+        static_assert(sizeof(many) == 200 * sizeof(double));
+        assert(evaluate<FastMath<1e-7>>(many, 2.0) == 199 * 200);
+    }
+}
@@ -0,0 +1,158 @@
+#include <veritacpp/dsl/math/nbody.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+using veritacpp::dsl::math::Particles;
+
+// particles on a jittered cubic lattice of side cells * spacing
+Particles lattice(size_t cells, double spacing) {
+    Particles p{ cells * cells * cells };
+    uint64_t seed = 12345;
+    const auto jitter = [&] {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return (double(seed >> 11) / double(1ull << 53) - 0.5) * 0.1 * spacing;
+    };
+    size_t i = 0;
+    for (size_t a = 0; a < cells; ++a) {
+        for (size_t b = 0; b < cells; ++b) {
+            for (size_t c = 0; c < cells; ++c, ++i) {
+                p.position(0)[i] = (double(a) + 0.5) * spacing + jitter();
+                p.position(1)[i] = (double(b) + 0.5) * spacing + jitter();
+                p.position(2)[i] = (double(c) + 0.5) * spacing + jitter();
+            }
+        }
+    }
+    return p;
+}
+
+} // namespace
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto r = Variable<0>{};
+
+    // a spring between two particles: F = -k (r - r0) along the separation
+    {
+        const auto spring = 0.5 * 3.0 * ((r - 1.0) ^ Constant<2>{});
+        Particles p{ 2 };
+        p.position(0)[1] = 1.5;
+        p.position(1)[1] = 2.0;
+        assert(compute_forces(spring, p) == NBodyStatus::Success);
+        const double d = std::sqrt(1.5 * 1.5 + 2.0 * 2.0);
+        const double f = -3.0 * (d - 1);
+        assert(std::abs(p.force(0)[1] - f * 1.5 / d) < 1e-12);
+        assert(std::abs(p.force(1)[1] - f * 2.0 / d) < 1e-12);
+        assert(std::abs(p.force(0)[0] + p.force(0)[1]) < 1e-12);
+        assert(p.force(2)[0] == 0 && p.force(2)[1] == 0);
+        assert(std::abs(potential_energy(spring, p) - 1.5 * (d - 1) * (d - 1)) < 1e-12);
+
+        // out of reach of the cutoff
+        assert(compute_forces(spring, p, { .cutoff = 2.0 }) == NBodyStatus::Success);
+        assert(p.force(0)[1] == 0);
+    }
+
+    // Lennard-Jones fluid in a periodic box
+    const auto lj = 4.0 * ((r ^ Constant<-12>{}) - (r ^ Constant<-6>{}));
+    const NBodyOptions box{ .cutoff = 2.5, .box = 8 * 1.2 };
+    {
+        auto p = lattice(8, 1.2);
+        assert(compute_forces(lj, p, box) == NBodyStatus::Success);
+
+        // cell list against all pairs
+        double worst = 0;
+        for (size_t i = 0; i < p.size(); i += 37) {
+            double f[3] = {};
+            for (size_t j = 0; j < p.size(); ++j) {
+                double d[3];
+                double r2 = 0;
+                for (size_t a = 0; a < 3; ++a) {
+                    d[a] = p.position(a)[i] - p.position(a)[j];
+                    d[a] -= box.box * std::nearbyint(d[a] / box.box);
+                    r2 += d[a] * d[a];
+                }
+                if (i == j || r2 >= box.cutoff * box.cutoff) {
+                    continue;
+                }
+                const double dr = std::sqrt(r2);
+                const double w = 4 * (12 * std::pow(dr, -13) - 6 * std::pow(dr, -7)) / dr;
+                for (size_t a = 0; a < 3; ++a) {
+                    f[a] += w * d[a];
+                }
+            }
+            for (size_t a = 0; a < 3; ++a) {
+                worst = std::max(worst, std::abs(p.force(a)[i] - f[a]) / (1 + std::abs(f[a])));
+            }
+        }
+        assert(worst < 1e-10);
+
+        // forces of pairs cancel
+        for (size_t a = 0; a < 3; ++a) {
+            double total = 0;
+            for (size_t i = 0; i < p.size(); ++i) {
+                total += p.force(a)[i];
+            }
+            assert(std::abs(total) < 1e-9);
+        }
+
+        // fast kernels agree with the precise ones
+        auto q = lattice(8, 1.2);
+        compute_forces<FastMath<1e-12>>(lj, q, box);
+        for (size_t i = 0; i < p.size(); ++i) {
+            assert(std::abs(q.force(0)[i] - p.force(0)[i]) < 1e-8 * (1 + std::abs(p.force(0)[i])));
+        }
+
+        // the box should hold two cutoffs
+        assert(compute_forces(lj, p, { .cutoff = 7.0, .box = 9.6 }) == NBodyStatus::CutoffTooLarge);
+        assert(std::isnan(potential_energy(lj, p, { .box = 9.6 })));
+    }
+
+    // energy is conserved by velocity Verlet, up to a bounded error
+    {
+        auto p = lattice(6, 1.2);
+        const NBodyOptions small{ .cutoff = 2.5, .box = 6 * 1.2 };
+        for (size_t i = 0; i < p.size(); ++i) {
+            p.velocity(0)[i] = std::sin(double(i)) * 0.5;
+            p.velocity(1)[i] = std::cos(double(3 * i)) * 0.5;
+            p.velocity(2)[i] = std::sin(double(7 * i + 1)) * 0.5;
+        }
+        // the truncated potential jumps at the cutoff: shift it to zero there
+        const auto shifted = lj - RTConstant{ lj(2.5) };
+        const double e0 = potential_energy(shifted, p, small) + kinetic_energy(p);
+        double worst = 0;
+        for (int block = 0; block < 10; ++block) {
+            assert(velocity_verlet(shifted, p, 0.004, 10, small) == NBodyStatus::Success);
+            const double e = potential_energy(shifted, p, small) + kinetic_energy(p);
+            worst = std::max(worst, std::abs(e - e0));
+        }
+        assert(worst < 1e-2 * std::abs(e0));
+        for (size_t i = 0; i < p.size(); ++i) {
+            for (size_t a = 0; a < 3; ++a) {
+                assert(p.position(a)[i] >= 0 && p.position(a)[i] < small.box);
+            }
+        }
+    }
+
+    // two bodies in open space: a circular orbit stays circular
+    {
+        const auto gravity = -1.0 / r;
+        Particles p{ 2 };
+        p.position(0)[0] = -0.5;
+        p.position(0)[1] = 0.5;
+        // v^2 = G m / (4 * 0.5) for each body around the centre of mass
+        p.velocity(1)[0] = -std::sqrt(0.5);
+        p.velocity(1)[1] = std::sqrt(0.5);
+        velocity_verlet(gravity, p, 1e-3, 5000);
+        const double dx = p.position(0)[1] - p.position(0)[0];
+        const double dy = p.position(1)[1] - p.position(1)[0];
+        assert(std::abs(std::hypot(dx, dy) - 1) < 1e-5);
+        // momentum stays zero
+        assert(std::abs(p.velocity(1)[0] + p.velocity(1)[1]) < 1e-12);
+    }
+
+}
@@ -0,0 +1,101 @@
+#include <veritacpp/dsl/math/ode.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto t = Variable<0>{};
+    constexpr auto y0 = Variable<1>{};
+    constexpr auto y1 = Variable<2>{};
+
+    // harmonic oscillator: a full period returns to the start
+    const auto oscillator = ode_system(y1, -1.0 * y0);
+    constexpr double period = 2 * std::numbers::pi;
+    {
+        const auto y = rk4(oscillator, 0, { 1.0, 0.0 }, period, 200);
+        assert(std::abs(y[0] - 1) < 1e-6 && std::abs(y[1]) < 1e-6);
+
+        const auto s = dormand_prince(oscillator, 0, { 1.0, 0.0 }, period,
+                                      { .relative_tolerance = 1e-10, .absolute_tolerance = 1e-12 });
+        assert(s.status == OdeStatus::Success);
+        assert(s.t == period);
+        assert(std::abs(s.y[0] - 1) < 1e-8 && std::abs(s.y[1]) < 1e-8);
+
+        // a looser tolerance takes fewer steps
+        const auto loose = dormand_prince(oscillator, 0, { 1.0, 0.0 }, period);
+        assert(loose.steps < s.steps);
+        assert(std::abs(loose.y[0] - 1) < 1e-4);
+    }
+
+    // time dependent right hand side: y = exp(-t^2)
+    {
+        const auto gauss = ode_system(-2.0 * t * y0);
+        const auto y = rk4(gauss, 0, { 1.0 }, 2, 100);
+        assert(std::abs(y[0] - std::exp(-4.0)) < 1e-7);
+        const auto s = dormand_prince(gauss, 0, { 1.0 }, 2);
+        assert(std::abs(s.y[0] - std::exp(-4.0)) < 1e-6);
+        const auto r = rosenbrock(gauss, 0, { 1.0 }, 2, { .relative_tolerance = 1e-8 });
+        assert(r.status == OdeStatus::Success);
+        assert(std::abs(r.y[0] - std::exp(-4.0)) < 1e-6);
+    }
+
+    // stiff: y' = -1e4 (y - cos t) - sin t, solution cos t
+    {
+        const auto stiff = ode_system(-1e4 * (y0 - cos(t)) - sin(t));
+        const auto r = rosenbrock(stiff, 0, { 1.0 }, 10, { .relative_tolerance = 1e-4, .absolute_tolerance = 1e-6 });
+        assert(r.status == OdeStatus::Success);
+        assert(std::abs(r.y[0] - std::cos(10.0)) < 1e-4);
+        const auto e = dormand_prince(stiff, 0, { 1.0 }, 10, { .relative_tolerance = 1e-4, .absolute_tolerance = 1e-6 });
+        assert(e.status == OdeStatus::Success);
+        // the explicit method is held back by stability, not accuracy
+        assert(r.steps * 20 < e.steps);
+
+        // step limit
+        const auto cut = dormand_prince(stiff, 0, { 1.0 }, 10, { .max_steps = 50 });
+        assert(cut.status == OdeStatus::MaxSteps && cut.t < 10);
+    }
+
+    // ensembles agree with members integrated one by one
+    {
+        constexpr size_t n = 37; // not a multiple of the lane count
+        Ensemble<2> ensemble{ n };
+        for (size_t k = 0; k < n; ++k) {
+            ensemble.set_state(k, { double(k) / 10, 1 - double(k) / n });
+        }
+        const Ensemble<2> initial = ensemble;
+
+        rk4(oscillator, 0, ensemble, 1, 50);
+        for (size_t k = 0; k < n; ++k) {
+            const auto one = rk4(oscillator, 0, initial.state(k), 1, 50);
+            assert(ensemble.state(k) == one);
+        }
+
+        ensemble = initial;
+        const auto status = dormand_prince(oscillator, 0, ensemble, period);
+        assert(status.size() == n);
+        for (size_t k = 0; k < n; ++k) {
+            assert(status[k] == OdeStatus::Success);
+            const auto y = ensemble.state(k);
+            const auto y_0 = initial.state(k);
+            assert(std::abs(y[0] - y_0[0]) < 1e-4 && std::abs(y[1] - y_0[1]) < 1e-4);
+        }
+
+        ensemble = initial;
+        const auto implicit = rosenbrock(oscillator, 0, ensemble, 1);
+        for (size_t k = 0; k < n; ++k) {
+            assert(implicit[k] == OdeStatus::Success);
+            const auto one = rosenbrock(oscillator, 0, initial.state(k), 1);
+            assert(ensemble.state(k) == one.y);
+        }
+
+        // component access is contiguous over the members
+        assert(ensemble.component(1) == ensemble.component(0) + n);
+    }
+
+    return 0;
+}
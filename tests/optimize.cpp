@@ -0,0 +1,69 @@
+#include <veritacpp/dsl/math/optimize.hpp>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto a = Variable<2>{};
+    constexpr auto b = Variable<3>{};
+
+    // gradient is built from diff
+    {
+        constexpr auto f = (x^Constant<2>{}) * y + sin(y);
+        constexpr auto g = gradient<2>(f);
+        static_assert(std::get<0>(g)(3.0, 2.0) == 12);
+        assert(std::get<1>(g)(3.0, 2.0) == 9 + std::cos(2.0));
+    }
+
+    // Rosenbrock function, minimum at (1, 1)
+    {
+        const auto rosenbrock = (1.0 - x)^Constant<2>{};
+        const auto f = rosenbrock + 100.0 * ((y - (x^Constant<2>{}))^Constant<2>{});
+        const auto m = minimize<2>(f, { -1.2, 1.0 }, { .gradient_tolerance = 1e-10 });
+        assert(m.status == MinimizeStatus::Converged);
+        assert(std::abs(m.x[0] - 1) < 1e-7 && std::abs(m.x[1] - 1) < 1e-7);
+        assert(m.value < 1e-14);
+        assert(m.iterations < 100);
+    }
+
+    // coefficients: (x - a)^2 + (y - b)^4 has its minimum at (a, b)
+    {
+        const auto f = ((x - a)^Constant<2>{}) + ((y - b)^Constant<4>{});
+        LbfgsWorkspace<2> workspace;
+        const auto m = minimize<2>(f, { 0.0, 0.0 }, {}, workspace, 3.0, -2.0);
+        assert(std::abs(m.x[0] - 3) < 1e-8);
+        assert(std::abs(m.x[1] + 2) < 1e-2);
+
+        // many problems on the thread pool give the same results as one by one
+        constexpr size_t n = 500;
+        std::vector<std::array<double, 2>> starts(n);
+        std::vector<double> as(n), bs(n);
+        for (size_t k = 0; k < n; ++k) {
+            starts[k] = { double(k % 7), -double(k % 3) };
+            as[k] = 0.01 * double(k);
+            bs[k] = std::sin(double(k));
+        }
+        const auto all = minimize_all<2>(f, starts, {}, as, bs);
+        assert(all.size() == n);
+        for (size_t k = 0; k < n; ++k) {
+            const auto one = minimize<2>(f, starts[k], {}, as[k], bs[k]);
+            assert(all[k].status == MinimizeStatus::Converged);
+            assert(all[k].x == one.x && all[k].iterations == one.iterations);
+            assert(std::abs(all[k].x[0] - as[k]) < 1e-6 && all[k].value < 1e-10);
+        }
+    }
+
+    // unbounded below: the line search keeps growing the step until f is not finite
+    {
+        const auto m = minimize<1>(-exp(x), { 0.0 }, { .max_iterations = 20 });
+        assert(m.status != MinimizeStatus::Converged);
+        assert(std::isfinite(m.value));
+    }
+}
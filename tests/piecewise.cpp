@@ -0,0 +1,95 @@
+#include <veritacpp/dsl/math/evaluate.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/interval.hpp>
+#include <veritacpp/dsl/math/cost.hpp>
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // values
+    {
+        static_assert(abs(x)(-2.5) == 2.5 && abs(x)(3) == 3);
+        static_assert(sign(x)(-2.0) == -1 && sign(x)(0.0) == 0 && sign(x)(7) == 1);
+        static_assert(min(x, y)(1, 2) == 1 && min(x, y)(3, 2) == 2);
+        static_assert(max(x, 0.0)(-1.0) == 0 && max(x, 0.0)(4.0) == 4);
+        static_assert(clamp(x * y, -1.0, 1.0)(2.0, 3.0) == 1);
+        static_assert(clamp(x * y, -1.0, 1.0)(-2.0, 3.0) == -1);
+        static_assert(clamp(x * y, -1.0, 1.0)(0.5, 0.5) == 0.25);
+        static_assert(select(x - y, x * x, y)(3.0, 1.0) == 9);
+        static_assert(select(x - y, x * x, y)(1.0, 3.0) == 3);
+        static_assert(std::same_as<decltype(select(x, y, y)), Variable<1>>);
+
+        constexpr auto f = max(sin(x), cos(x)) + abs(x - 1.0);
+        for (double t = -5; t < 5; t += 0.01) {
+            assert(f(t) == std::max(std::sin(t), std::cos(t)) + std::abs(t - 1));
+            assert(evaluate(f, t) == f(t));
+            assert(std::abs(evaluate<FastMath<1e-10>>(f, t) - f(t)) < 1e-9);
+        }
+    }
+
+    // derivatives of the selected piece, 0 at the kinks of abs
+    {
+        constexpr auto da = diff(abs(x), x);
+        static_assert(da(-2.0) == -1 && da(3.0) == 1 && da(0.0) == 0);
+
+        constexpr auto f = max(x * x, 2.0 * x);
+        constexpr auto df = diff(f, x);
+        assert(df(3.0) == 6 && df(1.0) == 2 && df(-1.0) == -2);
+
+        constexpr auto g = clamp(x * y, -1.0, 1.0);
+        constexpr auto dg = diff(g, y);
+        assert(dg(0.5, 1.0) == 0.5 && dg(2.0, 3.0) == 0 && dg(-2.0, 3.0) == 0);
+
+        constexpr auto s = select(x, sin(y), y * y);
+        assert(diff(s, y)(1.0, 0.5) == std::cos(0.5) && diff(s, y)(-1.0, 0.5) == 1);
+    }
+
+    // enclosures
+    {
+        assert(bound(abs(x), Box<1>{ Interval{ -2, 1 } }) == Interval(0, 2));
+        assert(bound(abs(x), Box<1>{ Interval{ -3, -1 } }) == Interval(1, 3));
+        assert(bound(sign(x), Box<1>{ Interval{ -3, 1 } }) == Interval(-1, 1));
+        assert(bound(min(x, y), Box<2>{ Interval{ 0, 2 }, Interval{ 1, 3 } }) == Interval(0, 2));
+        assert(bound(max(x, y), Box<2>{ Interval{ 0, 2 }, Interval{ 1, 3 } }) == Interval(1, 3));
+        assert(bound(clamp(x, 0.0, 1.0), Box<1>{ Interval{ -5, 0.5 } }) == Interval(0, 0.5));
+        assert(bound(select(x, y, -1.0 * y), Box<2>{ Interval{ 1, 2 }, Interval{ 1, 3 } }).lo >= 1);
+        const auto hull = bound(select(x, y, -1.0 * y), Box<2>{ Interval{ -1, 2 }, Interval{ 1, 3 } });
+        assert(hull.lo <= -3 && hull.hi >= 3);
+
+        const auto f = max(sin(x), cos(x)) + abs(x - 1.0);
+        const auto r = bound(f, Box<1>{ Interval{ -2, 3 } });
+        for (double t = -2; t <= 3; t += 0.01) {
+            assert(r.contains(f(t)));
+        }
+    }
+
+    // batched evaluation
+    {
+        constexpr auto f = clamp(x * y, -1.0, 1.0) + abs(y);
+        std::vector<double> xs(1000), ys(1000), out(1000);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            xs[i] = i * 0.003 - 1;
+            ys[i] = i * 0.01 - 5;
+        }
+        evaluate_batch(f, out, xs, ys);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            assert(out[i] == std::clamp(xs[i] * ys[i], -1.0, 1.0) + std::abs(ys[i]));
+        }
+    }
+
+    // costs
+    {
+        static_assert(cost_v<decltype(min(x, y))> == Cost{ 1, 0, 3 });
+        static_assert(cost_v<decltype(abs(sin(x)))>.transcendentals == 1);
+    }
+}
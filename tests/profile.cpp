@@ -0,0 +1,66 @@
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/cost.hpp>
+#include <veritacpp/dsl/math/profile.hpp>
+
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    // static cost model
+    {
+        static_assert(cost_v<decltype(x)> == Cost{ 0, 0, 1 });
+        static_assert(cost_v<decltype(x + y)> == Cost{ 1, 0, 3 });
+        static_assert(cost_v<decltype(x * y + y * x * 2.0)> == Cost{ 4, 0, 8 });
+        static_assert(cost_v<decltype(sin(x) * exp(y))> == Cost{ 1, 2, 7 });
+        static_assert(cost_v<Pow<2>> == Cost{ 1, 0, 1 });
+        static_assert(cost_v<Pow<7>> == Cost{ 4, 0, 1 });
+        static_assert(cost_v<Pow<-1>> == Cost{ 1, 0, 1 });
+        static_assert(cost_v<Pow<0.5>> == Cost{ 0, 1, 1 });
+
+        // differentiation of a product of transcendentals doubles their count
+        constexpr auto f = sin(x) * exp(x);
+        static_assert(cost_v<decltype(diff(f, x))>.transcendentals == 4);
+        static_assert(cost_v<decltype(diff(f, y))> == cost_v<Constant<0>>);
+    }
+
+    // instrumented evaluation
+    {
+        static_assert(std::is_empty_v<detail::EvaluationScope<Precise, Sin>>);
+
+        const auto f = sin(x) * y + exp(x);
+        thread_profile().clear();
+        const double profiled = evaluate<Profiled<>>(f, 0.5, 2.0);
+        assert(profiled == evaluate(f, 0.5, 2.0));
+        evaluate<Profiled<FastMath<1e-6>>>(f, 0.5, 2.0);
+
+        const auto& nodes = thread_profile().nodes();
+        assert(nodes.at("Add").calls == 2);
+        assert(nodes.at("Sin").calls == 2);
+        assert(nodes.at("Variable").calls == 6);
+        assert(nodes.at("App").calls == 4);
+        for (const auto& [name, stats] : nodes) {
+            assert(stats.self <= stats.total);
+        }
+
+        std::ostringstream collapsed;
+        thread_profile().write_collapsed(collapsed);
+        const auto report = collapsed.str();
+        assert(report.find("Add;Mul;App;Sin ") != std::string::npos);
+        assert(report.find("Add;App;Exp ") != std::string::npos);
+
+        std::ostringstream summary;
+        thread_profile().write_summary(summary);
+        assert(summary.str().find("Sin\t2\t") != std::string::npos);
+
+        thread_profile().clear();
+        assert(thread_profile().nodes().empty());
+    }
+}
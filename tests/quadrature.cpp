@@ -0,0 +1,87 @@
+#include <veritacpp/dsl/math/quadrature.hpp>
+
+#include <veritacpp/utils/thread_pool.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto a = Variable<2>{};
+
+    // smooth integrands converge on the first panels
+    {
+        const auto q = integrate(sin(x), x, 0, std::numbers::pi, 1e-12);
+        assert(q.status == QuadratureStatus::Converged);
+        assert(std::abs(q.value - 2) < 1e-13);
+        assert(q.error < 1e-12);
+        assert(q.evaluations <= 45);
+
+        // reversed bounds change the sign
+        const auto r = integrate(sin(x), x, std::numbers::pi, 0, 1e-12);
+        assert(std::abs(r.value + 2) < 1e-13);
+    }
+
+    // coefficients fill the other variables: integral of exp(-a y^2) over y
+    {
+        const auto f = exp(-1.0 * a * y * y) + 0.0 * x;
+        const auto q = integrate(f, y, -6, 6, 1e-12, 0.0, 2.0);
+        assert(q.status == QuadratureStatus::Converged);
+        assert(std::abs(q.value - std::sqrt(std::numbers::pi / 2)) < 1e-11);
+    }
+
+    // endpoint singularity: integral of log(x) over [0, 1] is -1
+    {
+        const auto q = integrate(log(x), x, 0, 1, 1e-10);
+        assert(q.status == QuadratureStatus::Converged);
+        assert(std::abs(q.value + 1) < 1e-9);
+
+        // too few panels
+        const auto cut = integrate(log(x), x, 0, 1, IntegrateOptions{ .tolerance = 1e-14, .max_panels = 4 });
+        assert(cut.status == QuadratureStatus::MaxEvaluations);
+    }
+
+    // fast kernels
+    {
+        const auto q = integrate<FastMath<1e-12>>(exp(x), x, 0, 1, 1e-10);
+        assert(std::abs(q.value - (std::numbers::e - 1)) < 1e-9);
+    }
+
+    // quasi-Monte Carlo over boxes
+    {
+        // integral of x y over [0, 1] x [0, 2] is 1
+        const auto q = integrate_nd<2>(x * y, { 0.0, 0.0 }, { 1.0, 2.0 }, { .tolerance = 1e-5 });
+        assert(q.status == QuadratureStatus::Converged);
+        assert(std::abs(q.value - 1) < 1e-4);
+
+        // with a coefficient: cos(a (x + y)) over the unit square
+        const auto g = cos(a * (x + y));
+        const auto c = integrate_nd<2>(g, { 0.0, 0.0 }, { 1.0, 1.0 }, { .tolerance = 1e-5 }, 1.5);
+        // the real part of (integral of exp(i a x) over [0, 1])^2
+        const double expected = (std::sin(1.5) * std::sin(1.5) - (1 - std::cos(1.5)) * (1 - std::cos(1.5)))
+                              / (1.5 * 1.5);
+        assert(std::abs(c.value - expected) < 1e-4);
+        assert(c.error < 1e-4);
+
+        // results do not depend on the number of threads
+        for (size_t threads : { 1, 5 }) {
+            veritacpp::utils::ThreadPool pool{ threads };
+            const auto again = integrate_nd<2>(g, { 0.0, 0.0 }, { 1.0, 1.0 },
+                                               { .tolerance = 1e-5, .pool = &pool }, 1.5);
+            assert(again.value == c.value && again.error == c.error);
+        }
+
+        // point limit
+        const auto cut = integrate_nd<2>(g, { 0.0, 0.0 }, { 1.0, 1.0 },
+                                         { .tolerance = 1e-15, .initial_points = 256, .max_points = 1024 }, 1.5);
+        assert(cut.status == QuadratureStatus::MaxEvaluations);
+        assert(cut.evaluations == 1024 * 8);
+    }
+
+    return 0;
+}
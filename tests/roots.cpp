@@ -0,0 +1,85 @@
+#include <veritacpp/dsl/math/roots.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto a = Variable<1>{};
+    constexpr auto b = Variable<2>{};
+
+    // a x^2 - b = 0 for many coefficients, batches of uneven size
+    {
+        constexpr size_t n = 1001;
+        std::vector<double> guesses(n, 1.0), as(n), bs(n);
+        for (size_t k = 0; k < n; ++k) {
+            as[k] = 1 + 0.01 * double(k);
+            bs[k] = 2 + double(k);
+        }
+        const auto f = a * (x^Constant<2>{}) - b;
+        for (const auto& roots : { solve_roots(f, x, guesses, 1e-13, as, bs),
+                                   solve_roots<RootMethod::Halley>(f, x, guesses, 1e-13, as, bs) }) {
+            assert(roots.x.size() == n);
+            for (size_t k = 0; k < n; ++k) {
+                assert(roots.status[k] == RootStatus::Converged);
+                assert(std::abs(roots.x[k] - std::sqrt(bs[k] / as[k])) <= 1e-12 * roots.x[k]);
+            }
+        }
+
+        // fast kernels give the same roots up to their tolerance
+        const auto fast = solve_roots<RootMethod::Newton, FastMath<1e-12>>(f, x, guesses, 1e-13, as, bs);
+        for (size_t k = 0; k < n; ++k) {
+            assert(std::abs(fast.x[k] - std::sqrt(bs[k] / as[k])) <= 1e-10);
+        }
+    }
+
+    // the unknown need not be the first variable,
+    // coefficients go to x and a here and x is unused
+    {
+        const std::vector<double> guesses = { 0.5, 0.5, 0.5 };
+        const std::vector<double> unused = { 0.0, 0.0, 0.0 };
+        const std::vector<double> values = { 1.0, 2.0, 3.0 };
+        const auto roots = solve_roots(exp(b) - a, b, guesses, 1e-14, unused, values);
+        assert(std::abs(roots.x[0] - 0) <= 1e-14);
+        assert(std::abs(roots.x[1] - std::log(2.0)) <= 1e-14);
+        assert(std::abs(roots.x[2] - std::log(3.0)) <= 1e-14);
+    }
+
+    // Halley converges faster on cos(x) = x
+    {
+        constexpr double root = 0.7390851332151607;
+        const std::vector<double> guesses = { 0.0, 1.0, -2.0 };
+        const RootOptions options{ .tolerance = 1e-15, .max_iterations = 5 };
+        const auto halley = solve_roots<RootMethod::Halley>(cos(x) - x, x, guesses, options);
+        const auto newton = solve_roots<RootMethod::Newton>(cos(x) - x, x, guesses, options);
+        for (size_t k = 0; k < guesses.size(); ++k) {
+            assert(std::abs(halley.x[k] - root) <= 1e-15);
+        }
+        assert(std::abs(newton.x[2] - root) > 1e-6);
+    }
+
+    // Newton alone cycles 0 -> 1 -> 0 on x^3 - 2x + 2, bisection breaks the cycle
+    {
+        const auto f = (x^Constant<3>{}) - 2 * x + 2.0;
+        const std::vector<double> guesses = { 0.0 };
+        const auto plain = solve_roots(f, x, guesses, RootOptions{ .max_iterations = 50 });
+        assert(plain.status[0] == RootStatus::MaxIterations);
+
+        const auto bracketed = solve_roots(f, x, guesses,
+                                           RootOptions{ .lower = -3, .upper = 3 });
+        assert(bracketed.status[0] == RootStatus::Converged);
+        assert(std::abs(bracketed.x[0] + 1.7692923542386314) <= 1e-12);
+    }
+
+    // a flat start without a bracket fails instead of producing garbage
+    {
+        const std::vector<double> guesses = { 0.0 };
+        const auto roots = solve_roots((x^Constant<2>{}) + 1.0, x, guesses, 1e-12);
+        assert(roots.status[0] == RootStatus::Failed);
+        assert(roots.x[0] == 0);
+    }
+}
@@ -0,0 +1,100 @@
+#include <veritacpp/dsl/math/sampling.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <set>
+#include <utility>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto a = Variable<2>{};
+
+    // the polyline stays close to the curve
+    const auto check_curve = [](const auto& f, const Samples& s, double tolerance) {
+        for (size_t i = 0; i + 1 < s.x.size(); ++i) {
+            assert(s.x[i] < s.x[i + 1]);
+            assert(s.y[i] == f(s.x[i]));
+            for (int k = 1; k < 8; ++k) {
+                const double t = k / 8.0;
+                const double u = s.x[i] + t * (s.x[i + 1] - s.x[i]);
+                const double line = s.y[i] + t * (s.y[i + 1] - s.y[i]);
+                assert(std::abs(f(u) - line) < tolerance);
+            }
+        }
+    };
+
+    // flat regions get few points, the bump many
+    {
+        const auto f = exp(-100.0 * (x^Constant<2>{}));
+        const auto s = adaptive_sample(f, x, -5, 5, 1e-3);
+        assert(s.x.front() == -5 && s.x.back() == 5);
+        check_curve(f, s, 2e-3);
+        size_t inside = 0;
+        for (double v : s.x) {
+            inside += std::abs(v) < 0.5;
+        }
+        assert(inside * 2 > s.x.size());
+        // a uniform grid fine enough near the bump would need thousands
+        assert(s.x.size() < 300);
+    }
+
+    // a full period between initial points is still resolved
+    {
+        const auto f = sin(x);
+        const auto s = adaptive_sample(f, x, 0, 32 * std::numbers::pi, 1e-3, SampleOptions{ .initial_points = 17 });
+        check_curve(f, s, 2e-3);
+    }
+
+    // coefficients and a fast policy
+    {
+        const auto f = sin(a * x) + 0.0 * y;
+        const auto s = adaptive_sample<FastMath<1e-12>>(f, x, 0, 1, 1e-4, 0.0, 20.0);
+        for (size_t i = 0; i < s.x.size(); ++i) {
+            assert(std::abs(s.y[i] - std::sin(20 * s.x[i])) < 1e-10);
+        }
+        assert(s.x.size() > 100);
+    }
+
+    // surfaces: conforming mesh refined around the peak
+    {
+        const auto f = exp(-20.0 * ((x^Constant<2>{}) + (y^Constant<2>{})));
+        const auto mesh = adaptive_mesh(f, x, y, { -2.0, 2.0 }, { -2.0, 2.0 }, 1e-3,
+                                        SampleOptions{ .initial_points = 9 });
+        assert(mesh.x.size() == mesh.y.size() && mesh.x.size() == mesh.z.size());
+        assert(mesh.x.size() > 81);
+        double area = 0;
+        // every interior edge is shared by exactly two triangles with opposite directions
+        std::set<std::pair<uint32_t, uint32_t>> edges;
+        for (const auto& t : mesh.triangles) {
+            const double ux = mesh.x[t[1]] - mesh.x[t[0]], uy = mesh.y[t[1]] - mesh.y[t[0]];
+            const double vx = mesh.x[t[2]] - mesh.x[t[0]], vy = mesh.y[t[2]] - mesh.y[t[0]];
+            const double twice = ux * vy - uy * vx;
+            assert(twice > 0);
+            area += 0.5 * twice;
+            for (size_t e = 0; e < 3; ++e) {
+                assert(edges.insert({ t[e], t[(e + 1) % 3] }).second);
+            }
+        }
+        assert(std::abs(area - 16) < 1e-12);
+        for (const auto& [p, q] : edges) {
+            const bool boundary = (std::abs(mesh.x[p]) == 2 && mesh.x[p] == mesh.x[q]) ||
+                                  (std::abs(mesh.y[p]) == 2 && mesh.y[p] == mesh.y[q]);
+            assert(boundary || edges.contains({ q, p }));
+        }
+        for (size_t v = 0; v < mesh.x.size(); ++v) {
+            assert(mesh.z[v] == f(mesh.x[v], mesh.y[v]));
+        }
+        // refinement concentrates near the peak
+        size_t near = 0;
+        for (size_t v = 0; v < mesh.x.size(); ++v) {
+            near += std::hypot(mesh.x[v], mesh.y[v]) < 0.7;
+        }
+        assert(near * 2 > mesh.x.size());
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <veritacpp/dsl/math/serialize.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto z = Variable<2>{};
+
+    const auto close = [](double a, double b) {
+        return std::abs(a - b) <= 1e-13 * std::max(1.0, std::abs(b));
+    };
+
+    // images evaluate as the expressions they were built from
+    {
+        const auto f = sin(x * y) + exp(-1.0 * y) / (2.0 + cos(x)) - (x^Constant<3>{}) + (y ^ 0.5);
+        const auto bytes = serialize(f);
+        const ExpressionImage image{ bytes };
+        assert(image.valid() && image.variables() == 2);
+        for (double u = -2; u < 2; u += 0.1) {
+            for (double v = 0.1; v < 3; v += 0.2) {
+                assert(close(image(u, v), f(u, v)));
+            }
+        }
+
+        // applications and derivatives: bound variables become registers
+        const auto g = (x * x + y) | (sin(y), z * 2.0);
+        assert(ExpressionImage{ serialize(g) }.variables() == 3);
+        assert(close(ExpressionImage{ serialize(g) }(1.0, 0.3, 2.0), g(1.0, 0.3, 2.0)));
+
+        const auto h = log(x * x + 1.0) * sin(y) | (x * y, x + y);
+        const auto dh = diff(diff(h, x), y);
+        const auto dbytes = serialize(dh);
+        const ExpressionImage dimage{ dbytes };
+        assert(dimage.valid());
+        for (double u = -1; u < 1; u += 0.13) {
+            assert(close(dimage(u, 0.7), dh(u, 0.7)));
+        }
+
+        // n-ary and piecewise nodes evaluate exactly as the expression;
+        // integral powers are rounded differently by the interpreter
+        const auto q = sum_of(x, y * Constant<2>{}, abs(x - y)) + max(x, y) * clamp(x, -1.0, 1.0) +
+                       select(x - 0.5, x, y) + product_of(x, y, sign(x));
+        const auto p = q + (x^Constant<-2>{});
+        const auto qbytes = serialize(q);
+        const auto pbytes = serialize(p);
+        const ExpressionImage qimage{ qbytes }, pimage{ pbytes };
+        for (double u = -3; u < 3; u += 0.17) {
+            assert(qimage(u, 0.4) == q(u, 0.4));
+            assert(close(pimage(u, 0.4), p(u, 0.4)));
+        }
+
+        // n-ary nodes round as they evaluate: pairwise, not left to right
+        constexpr auto w = Variable<3>{};
+        const auto s4 = sum_of(x, y, z, w);
+        assert(ExpressionImage{ serialize(s4) }(1e16, 1.0, -1e16, 1.0) == s4(1e16, 1.0, -1e16, 1.0));
+        const auto s5 = sum_of(x, y, z, w, x * y);
+        const auto p5 = product_of(x, y, z, w, x + y);
+        const auto s5bytes = serialize(s5);
+        const auto p5bytes = serialize(p5);
+        const ExpressionImage s5image{ s5bytes }, p5image{ p5bytes };
+        for (double u = -2; u < 2; u += 0.37) {
+            assert(s5image(u, 1e16, 0.3, -1e16) == s5(u, 1e16, 0.3, -1e16));
+            assert(p5image(u, 0.1, 1.7, 3.3) == p5(u, 0.1, 1.7, 3.3));
+        }
+
+        // shared constants are stored once
+        const auto c = x * 3.0 + y * 3.0 + 3.0;
+        assert(serialize(c).size() < serialize(x * 3.0 + y * 4.0 + 5.0).size());
+    }
+
+    // batched evaluation from an image
+    {
+        const auto f = exp(-x * x) * cos(y) + clamp(x * y, -1.0, 1.0);
+        const auto bytes = serialize(f);
+        const ExpressionImage image{ bytes };
+        std::vector<double> xs(1003), ys(1003), out(1003);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            xs[i] = i * 0.003 - 1;
+            ys[i] = i * 0.01;
+        }
+        evaluate_batch(image, out, xs, ys);
+        for (size_t i = 0; i < xs.size(); ++i) {
+            assert(close(out[i], f(xs[i], ys[i])));
+        }
+    }
+
+    // files are mapped and evaluated in place
+    {
+        const auto f = sin(x) * y + 1.5;
+        const std::string path = "serialize_test.vcpx";
+        assert(write_image(path, f) == ImageStatus::Ok);
+        const MappedExpression mapped{ path };
+        assert(mapped.valid());
+        assert(close(mapped(0.5, 2.0), f(0.5, 2.0)));
+        std::remove(path.c_str());
+
+        assert(MappedExpression{ "missing.vcpx" }.status() == ImageStatus::IoError);
+    }
+
+    // damaged images are rejected when opened
+    {
+        const auto bytes = serialize(x * y + 2.0);
+        const auto damaged = [&](auto change) {
+            auto copy = bytes;
+            change(copy);
+            return ExpressionImage{ copy }.status();
+        };
+        assert(damaged([](auto& b) { b[0] = std::byte{ 'X' }; }) == ImageStatus::BadMagic);
+        assert(damaged([](auto& b) { b[4] = std::byte{ 2 }; }) == ImageStatus::UnsupportedVersion);
+        assert(damaged([](auto& b) { std::swap(b[6], b[7]); }) == ImageStatus::ForeignByteOrder);
+        assert(damaged([](auto& b) { b.pop_back(); }) == ImageStatus::Truncated);
+        assert(damaged([](auto& b) { b.resize(b.size() + 8); }) == ImageStatus::Malformed);
+        assert(ExpressionImage{ std::span(bytes).first(10) }.status() == ImageStatus::Truncated);
+
+        // operand of the first instruction, an input, out of range
+        assert(damaged([](auto& b) { b[32 + 4] = std::byte{ 7 }; }) == ImageStatus::Malformed);
+        // unknown opcode
+        assert(damaged([](auto& b) { b[32] = std::byte{ 200 }; }) == ImageStatus::Malformed);
+        // last instruction removed from the count: stack unbalanced
+        assert(damaged([](auto& b) {
+            uint32_t code_size;
+            std::memcpy(&code_size, b.data() + 20, 4);
+            --code_size;
+            std::memcpy(b.data() + 20, &code_size, 4);
+            b.erase(b.begin() + 32 + 8 * code_size, b.begin() + 32 + 8 * code_size + 8);
+        }) == ImageStatus::Malformed);
+
+        // a register read before anything is stored into it
+        const auto applied = serialize(sin(x) | (y * 2.0));
+        assert(ExpressionImage{ applied }.valid());
+        auto unstored = applied;
+        const detail::ImageInstruction local{ detail::ImageOp::Local, 0 };
+        std::memcpy(unstored.data() + 32, &local, sizeof local);
+        assert(ExpressionImage{ unstored }.status() == ImageStatus::Malformed);
+    }
+}
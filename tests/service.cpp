@@ -0,0 +1,100 @@
+#include <veritacpp/dsl/math/service.hpp>
+
+#include <veritacpp/utils/work_stealing_pool.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto z = Variable<2>{};
+
+    // every task runs, also tasks submitted by tasks
+    {
+        std::atomic<int> count{ 0 };
+        {
+            veritacpp::utils::WorkStealingPool pool{ 3 };
+            for (int i = 0; i < 100; ++i) {
+                pool.submit([&] {
+                    ++count;
+                    pool.submit([&] { ++count; });
+                });
+            }
+        }
+        assert(count == 200);
+    }
+
+    // values are those of the expressions
+    {
+        EvaluationService service;
+        const auto f = service.add<2>(sin(x) * y + 1.0);
+        const auto g = service.add<3, FastMath<1e-12>>(exp(z) - x * y);
+        auto a = service.evaluate(f, 0.5, 2.0);
+        auto b = service.evaluate(g, 1.0, 2.0, 0.25);
+        auto c = service.evaluate(f, std::array{ 1.0, -1.0 });
+        assert(a.get() == std::sin(0.5) * 2.0 + 1.0);
+        assert(std::abs(b.get() - (std::exp(0.25) - 2.0)) < 1e-12);
+        assert(c.get() == -std::sin(1.0) + 1.0);
+    }
+
+    // concurrent requests are coalesced into full batches, all cut before the deadline
+    {
+        EvaluationService service{ { .threads = 2, .max_batch = 100,
+                                     .max_latency = std::chrono::seconds(60) } };
+        const auto f = service.add<2>(x * x + y);
+        constexpr int kThreads = 8;
+        constexpr int kRequests = 500;
+        std::vector<std::thread> clients;
+        std::atomic<int> wrong{ 0 };
+        for (int t = 0; t < kThreads; ++t) {
+            clients.emplace_back([&, t] {
+                std::vector<std::future<double>> results;
+                for (int i = 0; i < kRequests; ++i) {
+                    results.push_back(service.evaluate(f, double(i), double(t)));
+                }
+                for (int i = 0; i < kRequests; ++i) {
+                    if (results[i].get() != double(i) * double(i) + double(t)) {
+                        ++wrong;
+                    }
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+        assert(wrong == 0);
+        const auto stats = service.stats();
+        assert(stats.requests == kThreads * kRequests);
+        assert(stats.batches == kThreads * kRequests / 100);
+    }
+
+    // a full queue is cut without waiting for the deadline
+    {
+        EvaluationService service{ { .max_batch = 64, .max_latency = std::chrono::seconds(60) } };
+        const auto f = service.add<1>(x + 1.0);
+        std::vector<std::future<double>> results;
+        for (int i = 0; i < 64; ++i) {
+            results.push_back(service.evaluate(f, double(i)));
+        }
+        assert(results[63].wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        assert(results[10].get() == 11);
+    }
+
+    // requests still waiting are evaluated by the destructor
+    std::future<double> late;
+    {
+        EvaluationService service{ { .max_latency = std::chrono::seconds(60) } };
+        late = service.evaluate(service.add<1>(x * 3.0), 2.0);
+    }
+    assert(late.get() == 6);
+
+}
@@ -0,0 +1,106 @@
+#include <veritacpp/dsl/math/fft.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <span>
+#include <vector>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+    using namespace std::complex_literals;
+    using C = std::complex<double>;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+
+    static_assert(Arithmetic<C> && Complex<C> && !Real<C>);
+
+    const auto close = [](C a, C b, double tolerance = 1e-12) {
+        return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+    };
+
+    // complex evaluation through every elementary node and diff
+    {
+        const auto f = exp(x * y) + sin(x) * cos(y) - log(x) / (x^Constant<3>{}) + (x ^ 0.5) + 2 * x;
+        const C u = 0.3 + 0.7i, v = -1.1 + 0.2i;
+        const C expected = std::exp(u * v) + std::sin(u) * std::cos(v) - std::log(u) / (u * u * u) +
+                           std::pow(u, 0.5) + 2.0 * u;
+        assert(close(f(u, v), expected));
+        assert(close(evaluate(f, u, v), expected));
+        assert(close(evaluate<FastMath<1e-10>>(f, u, v), expected));
+
+        // derivatives of holomorphic expressions against central differences
+        const auto df = diff(f, x);
+        const C h = 1e-6;
+        assert(close(df(u, v), (f(u + h, v) - f(u - h, v)) / (2.0 * h), 1e-8));
+
+        // complex exponents and constants
+        const auto g = (x ^ C(0, 1)) * C(2, 1);
+        assert(close(g(u), std::pow(u, 1.0i) * C(2, 1)));
+        assert(close(diff(g, x)(u), 1.0i * std::pow(u, 1.0i - 1.0) * C(2, 1)));
+        assert(abs(x)(C(3, 4)) == 5);
+
+        // a transfer function 1 / (1 + s tau) at s = i omega
+        const auto H = 1.0 / (1.0 + x * y);
+        assert(close(H(1.0i * 10.0, 0.1), 1.0 / (1.0 + 1.0i)));
+    }
+
+    // transforms against the definition, sizes with every kind of factor
+    for (size_t n : { 1, 2, 3, 4, 5, 7, 8, 12, 16, 30, 64, 97, 100, 210, 256, 1000, 1024 }) {
+        std::vector<C> signal(n);
+        for (size_t k = 0; k < n; ++k) {
+            signal[k] = C(std::sin(0.37 * k) + 0.1 * k, std::cos(1.3 * k));
+        }
+        const auto spectrum_of = fft(signal);
+        for (size_t j = 0; j < n; j += 1 + n / 17) {
+            C sum = 0;
+            for (size_t k = 0; k < n; ++k) {
+                sum += signal[k] * std::polar(1.0, -2 * std::numbers::pi * double(j * k % n) / double(n));
+            }
+            assert(close(spectrum_of[j], sum, 1e-10 * std::sqrt(double(n))));
+        }
+        const auto back = inverse_fft(spectrum_of);
+        for (size_t k = 0; k < n; ++k) {
+            assert(close(back[k], signal[k], 1e-12));
+        }
+        assert(&fft_plan(n) == &fft_plan(n));
+    }
+
+    // spectrum of an expression: two tones with a coefficient for the amplitude
+    {
+        const auto t = x;
+        const auto a = y;
+        const auto f = a * sin(2 * std::numbers::pi * 50.0 * t) + 0.5 * cos(2 * std::numbers::pi * 120.0 * t);
+        const double rate = 1000;
+        const size_t n = 1000;
+        const auto s = spectrum(f, t, rate, n, 3.0);
+        assert(s.bins.size() == n && s.resolution == 1);
+        assert(s.frequency(50) == 50);
+        assert(close(s.bins[50], C(0, -1.5 * n), 1e-9));
+        assert(close(s.bins[120], C(0.25 * n, 0), 1e-9));
+        assert(close(s.bins[n - 50], std::conj(s.bins[50]), 1e-9));
+        for (size_t j = 0; j < n; ++j) {
+            if (j != 50 && j != 120 && j != n - 50 && j != n - 120) {
+                assert(std::abs(s.bins[j]) < 1e-9);
+            }
+        }
+
+        // frames transformed into the caller's bins
+        std::vector<C> bins(n);
+        for (double amplitude : { 3.0, -1.0 }) {
+            spectrum(f, t, rate, std::span(bins), amplitude);
+            assert(close(bins[50], C(0, -0.5 * amplitude * n), 1e-9));
+            assert(close(bins[120], s.bins[120], 1e-9));
+        }
+
+        // complex signal: a single positive frequency
+        const auto phasor = exp(x * C(0, 2 * std::numbers::pi * 64.0));
+        const auto p = spectrum(phasor, x, 512.0, 512);
+        assert(close(p.bins[64], 512.0, 1e-9));
+        assert(std::abs(p.bins[512 - 64]) < 1e-9);
+    }
+}
@@ -0,0 +1,66 @@
+#include <veritacpp/dsl/math/tabulated.hpp>
+#include <veritacpp/dsl/math/differential.hpp>
+#include <veritacpp/dsl/math/evaluate.hpp>
+
+#include <cassert>
+#include <cmath>
+
+int main() {
+
+    using namespace veritacpp::dsl::math;
+
+    constexpr auto x = Variable<0>{};
+    constexpr auto y = Variable<1>{};
+    constexpr auto abs = [](double v) { return v < 0 ? -v : v; };
+
+    // table is sampled during constant evaluation
+    {
+        constexpr auto f = exp(x) * sin(x);
+        constexpr auto t = tabulate<64>(f, 0.0, 2.0);
+        static_assert(abs(t(0.7) - f(0.7)) < 1e-7);
+        static_assert(t(0.0) == f(0.0) && t(2.0) == f(2.0));
+
+        constexpr auto dt = diff(t, x);
+        constexpr auto df = diff(f, x);
+        static_assert(abs(dt(1.3) - df(1.3)) < 1e-4);
+        static_assert(std::is_same_v<decltype(diff(t, y)), Constant<0>>);
+
+        for (double v = 0; v <= 2; v += 0.001) {
+            assert(abs(t(v) - f(v)) < 1e-7);
+            assert(abs(dt(v) - df(v)) < 1e-4);
+            assert(abs(diff(dt, x)(v) - diff(df, x)(v)) < 1e-2);
+        }
+    }
+
+    // runtime sized table
+    {
+        constexpr auto f = log(x + 1.0) * cos(x);
+        const auto t = tabulate(f, -0.5, 3.0, 2000);
+        const auto dt = diff(t, x);
+        for (double v = -0.5; v <= 3; v += 0.0007) {
+            assert(abs(t(v) - f(v)) < 1e-10);
+            assert(abs(dt(v) - diff(f, x)(v)) < 1e-7);
+        }
+    }
+
+    // linear interpolation
+    {
+        constexpr auto t = tabulate<11, Interpolation::Linear>(x * x, 0.0, 1.0);
+        static_assert(abs(t(0.25) - 0.065) < 1e-12);
+        static_assert(abs(diff(t, x)(0.25) - 0.5) < 1e-12);
+        static_assert(std::is_same_v<decltype(diff(diff(t, x), x)), Constant<0>>);
+    }
+
+    // tables are ordinary nodes: composition, chain rule and policies
+    {
+        constexpr auto t = tabulate<128>(exp(x), 0.0, 4.0);
+        constexpr auto g = (t | (x * y)) + x;
+        constexpr auto dg = diff(g, y);
+        for (double v = 0.1; v < 1.9; v += 0.01) {
+            assert(abs(g(v, 2.0) - (std::exp(2 * v) + v)) < 1e-8 * std::exp(2 * v));
+            assert(abs(dg(v, 2.0) - v * std::exp(2 * v)) < 1e-4 * std::exp(2 * v));
+            assert(evaluate<FastMath<1e-9>>(g, v, 2.0) == g(v, 2.0));
+        }
+    }
+
+}
@@ -0,0 +1,40 @@
+#include <veritacpp/utils/thread_pool.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+int main() {
+
+    using veritacpp::utils::ThreadPool;
+
+    // every index exactly once
+    {
+        ThreadPool pool{ 4 };
+        std::atomic<size_t> sum{ 0 };
+        pool.parallel_for(1000, [&](size_t i) { sum += i; }, 7);
+        assert(sum == 999 * 1000 / 2);
+    }
+
+    // nested loops of the same pool run on the calling thread
+    {
+        ThreadPool pool{ 3 };
+        std::atomic<size_t> count{ 0 };
+        pool.parallel_for(8, [&](size_t) {
+            pool.parallel_for(16, [&](size_t) { ++count; }, 1);
+        }, 1);
+        assert(count == 8 * 16);
+    }
+
+    // a worker of b running a loop of a is still a worker of b afterwards
+    {
+        ThreadPool a{ 3 };
+        ThreadPool b{ 3 };
+        std::atomic<size_t> count{ 0 };
+        b.parallel_for(8, [&](size_t) {
+            a.parallel_for(64, [&](size_t) { ++count; }, 1);
+            b.parallel_for(4, [&](size_t) { ++count; }, 1);
+        }, 1);
+        assert(count == 8 * (64 + 4));
+    }
+}
@@ -0,0 +1,92 @@
+#include <veritacpp/utils/tuple.hpp>
+
+#include <cassert>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace {
+
+// counts copies of the elements
+struct Tracked {
+    int value = 0;
+    static inline int copies = 0;
+
+    Tracked(int v) : value{ v } {}
+    Tracked(const Tracked& other) : value{ other.value } { ++copies; }
+};
+
+} // namespace
+
+int main() {
+
+    using namespace veritacpp::utils;
+
+    // views refer to the elements of the tuple
+    {
+        auto t = std::make_tuple(1, 2.5, std::string{ "three" });
+        auto v = view(t);
+        static_assert(std::tuple_size_v<decltype(v)> == 3);
+        static_assert(std::is_same_v<std::tuple_element_t<2, decltype(v)>, std::string&>);
+        assert(&get<2>(v) == &std::get<2>(t));
+        get<0>(v) = 10;
+        assert(std::get<0>(t) == 10);
+
+        auto [a, b, c] = v;
+        assert(a == 10 && b == 2.5 && c == "three");
+    }
+
+    // slice and split
+    {
+        auto t = std::make_tuple(0, 1, 2, 3, 4);
+        auto s = slice<1, 4>(t);
+        static_assert(std::tuple_size_v<decltype(s)> == 3);
+        assert(get<0>(s) == 1 && get<2>(s) == 3);
+        assert(&get<0>(slice<1, 2>(s)) == &std::get<2>(t));
+        static_assert(std::tuple_size_v<decltype(slice<2, 2>(t))> == 0);
+
+        auto [left, right] = split<2>(t);
+        static_assert(std::tuple_size_v<decltype(left)> == 2);
+        static_assert(std::tuple_size_v<decltype(right)> == 3);
+        assert(get<1>(left) == 1 && get<0>(right) == 2);
+
+        // past the end: everything on the left
+        auto [all, none] = split<7>(t);
+        static_assert(std::tuple_size_v<decltype(all)> == 5);
+        static_assert(std::tuple_size_v<decltype(none)> == 0);
+    }
+
+    // concat and apply
+    {
+        auto t1 = std::make_tuple(1, 2);
+        auto t2 = std::make_tuple(3);
+        const auto c = concat(view(t1), forward_as_view(), view(t2), slice<0, 1>(t1));
+        static_assert(std::tuple_size_v<decltype(c)> == 4);
+        assert(get<2>(c) == 3 && &get<3>(c) == &std::get<0>(t1));
+        assert(apply([](int a, int b, int c, int d) { return a * 1000 + b * 100 + c * 10 + d; }, c) == 1231);
+
+        // temporaries live until the end of the full expression
+        assert(apply([](int a, int b) { return a - b; }, forward_as_view(7, 2)) == 5);
+    }
+
+    // nothing is copied on the way to the function
+    {
+        auto t = std::make_tuple(Tracked{ 1 }, Tracked{ 2 }, Tracked{ 3 });
+        Tracked::copies = 0;
+        const int sum = apply([](const Tracked& a, const Tracked& b, const Tracked& c) {
+            return a.value + b.value + c.value;
+        }, concat(split<1>(t).second, slice<0, 1>(t)));
+        assert(sum == 6);
+        assert(Tracked::copies == 0);
+    }
+
+    // constant evaluation
+    {
+        constexpr int r = [] {
+            auto t = std::make_tuple(1, 2, 3);
+            return apply([](int a, int b) { return a * b; }, split<1>(t).second);
+        }();
+        static_assert(r == 6);
+    }
+
+}